@@ -0,0 +1,87 @@
+#include "common.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// Connection-establishment rate against the number of SO_REUSEPORT acceptor shards.
+// Several connecting threads open and close plain sockets as fast as they can,
+// the rate is taken once the server has registered every connection
+
+constexpr std::size_t connecting_threads_count {8};
+constexpr std::size_t connections_per_thread   {500};
+
+void connectMany(const nets::Port port)
+{
+    boost::asio::io_context io_context;
+
+    const boost::asio::ip::tcp::endpoint endpoint {boost::asio::ip::make_address("127.0.0.1"), port};
+
+    std::vector<nets::TcpSocket> sockets;
+
+    sockets.reserve(connections_per_thread);
+
+    for(std::size_t i {0}; i < connections_per_thread; ++i)
+    {
+        sockets.emplace_back(io_context).connect(endpoint);
+    }
+}
+
+void run(const nets::ListeningMode listening_mode, const std::size_t shards_count, const nets::Port port)
+{
+    BenchmarkServer server {Remote::PingTime{30}, Remote::PingTime{30}, shards_count, listening_mode};
+
+    server.setIpVersion(nets::IPVersion::ipv4);
+    server.setPort(port);
+    server.setPendingAcceptsCount(16);
+    server.setListenBacklog(4096);
+    server.startAccepting();
+
+    const auto connections_count {connecting_threads_count * connections_per_thread};
+
+    const auto start {Clock::now()};
+
+    {
+        std::vector<std::jthread> connecting_threads;
+
+        for(std::size_t i {0}; i < connecting_threads_count; ++i)
+        {
+            connecting_threads.emplace_back(connectMany, port);
+        }
+    }
+
+    const auto completed {
+        waitFor([&]{ return server.getClientsCount() >= connections_count; })
+    };
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "accept_shards",
+        std::format(
+            "\"mode\": \"{}\", \"shards\": {}, \"connections\": {}, \"completed\": {}, \"seconds\": {:.4f}, \"connections_per_second\": {:.0f}",
+            listening_mode == nets::ListeningMode::sharded_acceptors ? "sharded" : "single",
+            shards_count,
+            server.getClientsCount(),
+            completed,
+            elapsed,
+            server.getClientsCount() / elapsed
+        )
+    );
+
+    server.closeAllConnections();
+}
+
+int main()
+{
+    const auto max_shards_count {std::max<std::size_t>(std::thread::hardware_concurrency(), 1)};
+
+    nets::Port port {benchmarks_base_port};
+
+    // Baseline: one acceptor, as many io threads as the widest sharded run
+    run(nets::ListeningMode::single_acceptor, max_shards_count, port++);
+
+    for(std::size_t shards_count {1}; shards_count <= max_shards_count; shards_count *= 2)
+    {
+        run(nets::ListeningMode::sharded_acceptors, shards_count, port++);
+    }
+}
@@ -0,0 +1,122 @@
+#include "common.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+// Broadcast fan-out: the server broadcasts messages to every connected client,
+// the rate being taken in deliveries (messages times clients) per second
+
+constexpr std::size_t payload_size        {256};
+constexpr std::size_t deliveries_per_run  {2'000'000};
+
+// broadcast() never waits for a full client, skipping it instead: the producer paces itself,
+// checking every `pacing_interval` messages that no queue is past half of its limit
+constexpr std::size_t queue_messages_limit {20'000};
+constexpr std::size_t pacing_interval      {1'000};
+
+void run(const std::size_t clients_count, const nets::Port port)
+{
+    // Outlives the server and the clients, whose handlers count into it
+    std::atomic_size_t received_count {0};
+
+    const auto server {makeServer(port, std::max<std::size_t>(std::thread::hardware_concurrency(), 1))};
+
+    std::vector<std::unique_ptr<BenchmarkClient>> clients;
+
+    for(std::size_t i {0}; i < clients_count; ++i)
+    {
+        auto& client {*clients.emplace_back(makeClient(port))};
+
+        client.setHandlerDispatch(nets::HandlerDispatch::inline_strand);
+
+        client.server->setOnReceivingView(
+            MessageIds::message_response,
+            [&](nets::MessageView message, nets::TcpRemote<MessageIds>&)
+            {
+                received_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        );
+
+        if(!client.connect())
+        {
+            printResult("broadcast", "\"error\": \"connection failed\"");
+
+            return;
+        }
+    }
+
+    if(!waitFor([&]{ return server->getClientsCount() == clients_count; }))
+    {
+        printResult("broadcast", "\"error\": \"connection failed\"");
+
+        return;
+    }
+
+    const auto server_clients {server->getClients()};
+
+    for(const auto& server_client : *server_clients)
+    {
+        server_client->setOutgoingQueueLimits(8 * 1024 * 1024, queue_messages_limit);
+        server_client->setBackpressurePolicy(nets::BackpressurePolicy::reject);
+    }
+
+    const auto messages_count {deliveries_per_run / clients_count};
+
+    std::size_t deliveries_count {0};
+
+    const auto message {makeMessage(MessageIds::message_response, payload_size)};
+
+    const auto start {Clock::now()};
+
+    for(std::size_t i {0}; i < messages_count; ++i)
+    {
+        if(i % pacing_interval == 0)
+        {
+            waitFor(
+                [&]
+                {
+                    return std::ranges::all_of(
+                        *server_clients,
+                        [](const auto& client){ return client->getQueuedMessagesCount() < queue_messages_limit / 2; }
+                    );
+                }
+            );
+        }
+
+        deliveries_count += server->broadcast(message);
+    }
+
+    const auto completed {
+        waitFor([&]{ return received_count.load(std::memory_order_relaxed) == deliveries_count; })
+    };
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "broadcast",
+        std::format(
+            "\"clients\": {}, \"payload_bytes\": {}, \"messages\": {}, \"deliveries\": {}, \"skipped\": {}, "
+            "\"completed\": {}, \"seconds\": {:.4f}, \"deliveries_per_second\": {:.0f}",
+            clients_count,
+            payload_size,
+            messages_count,
+            received_count.load(),
+            messages_count * clients_count - deliveries_count,
+            completed,
+            elapsed,
+            received_count.load() / elapsed
+        )
+    );
+
+    server->closeAllConnections();
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 400};
+
+    for(const std::size_t clients_count : {1, 8, 64, 256})
+    {
+        run(clients_count, port++);
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../include/nets.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+enum class MessageIds
+{
+    ping_request, ping_response,
+    message_request,
+    message_response,
+    count
+};
+
+using Remote = nets::TcpRemote<MessageIds>;
+
+// Server that only accepts: benchmarks set their handlers on the clients they get
+class BenchmarkServer : public nets::TcpServer<MessageIds, Remote>
+{
+    public:
+        using TcpServer<MessageIds, Remote>::TcpServer;
+
+        virtual void onClientConnection(std::shared_ptr<Remote> client) override {}
+
+        virtual void onForbiddenClientConnection(std::shared_ptr<Remote> client) override {}
+};
+
+using BenchmarkClient = nets::TcpClient<MessageIds, Remote>;
+
+using Clock = std::chrono::steady_clock;
+
+// Ports are spread so that benchmarks can run in parallel. They're below the usual ephemeral
+// ports range, so that the connections a benchmark opens never take the port of the next one
+constexpr nets::Port benchmarks_base_port {27000};
+
+// Results are printed one JSON object per line, so they can be collected across releases
+inline void printResult(const std::string_view benchmark, const std::string_view fields)
+{
+    std::println("{{\"benchmark\": \"{}\", {}}}", benchmark, fields);
+}
+
+inline double toSeconds(const Clock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Message whose body is `payload_size` bytes
+inline mdsm::Collection makeMessage(const MessageIds message_id, const std::size_t payload_size)
+{
+    mdsm::Collection message;
+
+    message << message_id;
+
+    const auto header_size {message.getSize()};
+
+    message.resize(header_size + payload_size);
+
+    std::memset(message.getData() + header_size, 'x', payload_size);
+
+    return message;
+}
+
+// Response carrying the same body as the received request
+inline mdsm::Collection makeEcho(const nets::MessageView& request)
+{
+    auto response {makeMessage(MessageIds::message_response, request.getSize())};
+
+    std::memcpy(response.getData() + response.getSize() - request.getSize(), request.getData(), request.getSize());
+
+    return response;
+}
+
+// `quantile` in [0, 1] of sorted samples
+inline double getPercentile(const std::vector<double>& sorted_samples, const double quantile)
+{
+    if(sorted_samples.empty())
+    {
+        return 0;
+    }
+
+    return sorted_samples[static_cast<std::size_t>(quantile * static_cast<double>(sorted_samples.size() - 1))];
+}
+
+// Server listening on loopback, for benchmarks driving the library's own clients
+inline std::unique_ptr<BenchmarkServer> makeServer(
+    const nets::Port  port,
+    const std::size_t io_threads_count = 1
+)
+{
+    auto server {std::make_unique<BenchmarkServer>(Remote::PingTime{30}, Remote::PingTime{30}, io_threads_count)};
+
+    server->setIpVersion(nets::IPVersion::ipv4);
+    server->setPort(port);
+    server->startAccepting();
+
+    return server;
+}
+
+inline std::unique_ptr<BenchmarkClient> makeClient(const nets::Port port)
+{
+    return std::make_unique<BenchmarkClient>("127.0.0.1", std::to_string(port), Remote::PingTime{30}, Remote::PingTime{30});
+}
+
+// Waits until the predicate holds, returning false if it didn't within the timeout
+template <typename Predicate>
+bool waitFor(Predicate&& predicate, const Clock::duration timeout = std::chrono::seconds{30})
+{
+    const auto deadline {Clock::now() + timeout};
+
+    while(!predicate())
+    {
+        if(Clock::now() > deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+
+    return true;
+}
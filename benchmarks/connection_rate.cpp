@@ -0,0 +1,92 @@
+#include "common.hpp"
+
+#include <array>
+
+// Connections per second with churn: connecting threads open a connection, wait until
+// the server sent its first ping response back (so the remote is fully started on both ends)
+// then close it, against the number of connecting threads
+
+constexpr std::size_t connections_per_run {4'000};
+
+void connectMany(const nets::Port port, const std::size_t connections_count)
+{
+    boost::asio::io_context io_context;
+
+    const boost::asio::ip::tcp::endpoint endpoint {boost::asio::ip::make_address("127.0.0.1"), port};
+
+    // Ping request with sequence 0: the server's reply proves it's serving the connection
+    nets::FrameHeader header;
+
+    const auto ping_request {mdsm::Collection{} << MessageIds::ping_request << nets::PingSequence{0}};
+
+    const auto body_offset {sizeof(MessageIds)};
+
+    nets::encodeFrameHeader(
+        nets::toWireMessageId(MessageIds::ping_request), ping_request.getSize() - body_offset, 0, header
+    );
+
+    std::array<std::byte, 64> response;
+
+    for(std::size_t i {0}; i < connections_count; ++i)
+    {
+        nets::TcpSocket socket {io_context};
+
+        socket.connect(endpoint);
+
+        const std::array<boost::asio::const_buffer, 2> request {
+            boost::asio::buffer(header.getData(), header.getSize()),
+            boost::asio::buffer(ping_request.getData() + body_offset, ping_request.getSize() - body_offset)
+        };
+
+        boost::asio::write(socket, request);
+
+        socket.read_some(boost::asio::buffer(response));
+    }
+}
+
+void run(const std::size_t connecting_threads_count, const nets::Port port)
+{
+    const auto server {makeServer(port, std::max<std::size_t>(std::thread::hardware_concurrency(), 1))};
+
+    server->setPendingAcceptsCount(16);
+
+    const auto connections_per_thread {connections_per_run / connecting_threads_count};
+
+    const auto start {Clock::now()};
+
+    {
+        std::vector<std::jthread> connecting_threads;
+
+        for(std::size_t i {0}; i < connecting_threads_count; ++i)
+        {
+            connecting_threads.emplace_back(connectMany, port, connections_per_thread);
+        }
+    }
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    const auto metrics {server->getMetrics()};
+
+    printResult(
+        "connection_rate",
+        std::format(
+            "\"connecting_threads\": {}, \"connections\": {}, \"seconds\": {:.4f}, \"connections_per_second\": {:.0f}",
+            connecting_threads_count,
+            metrics.connections_accepted,
+            elapsed,
+            metrics.connections_accepted / elapsed
+        )
+    );
+
+    server->closeAllConnections();
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 500};
+
+    for(const std::size_t connecting_threads_count : {1, 4, 16})
+    {
+        run(connecting_threads_count, port++);
+    }
+}
@@ -0,0 +1,102 @@
+#include "common.hpp"
+
+#include <atomic>
+
+// Echo round trip time percentiles: a single client sends a request and waits for its response
+// before sending the next one, for several payload sizes and both handler dispatch modes
+
+constexpr std::size_t warmup_round_trips_count {1'000};
+constexpr std::size_t round_trips_count        {20'000};
+
+void run(const nets::HandlerDispatch dispatch, const std::size_t payload_size, const nets::Port port)
+{
+    // Outlives the server and the clients, whose handlers count into it
+    std::atomic_size_t responses_count {0};
+
+    const auto server {makeServer(port)};
+
+    server->setHandlerDispatch(dispatch);
+
+    const auto client {makeClient(port)};
+
+    client->setHandlerDispatch(dispatch);
+
+    if(!client->connect() || !waitFor([&]{ return server->getClientsCount() == 1; }))
+    {
+        printResult("echo_latency", "\"error\": \"connection failed\"");
+
+        return;
+    }
+
+    server->getClients()->front()->setOnReceivingView(
+        MessageIds::message_request,
+        [](nets::MessageView request, nets::TcpRemote<MessageIds>& server_client)
+        {
+            server_client.send(makeEcho(request));
+        }
+    );
+
+    client->server->setOnReceivingView(
+        MessageIds::message_response,
+        [&](nets::MessageView response, nets::TcpRemote<MessageIds>&)
+        {
+            responses_count.fetch_add(1, std::memory_order_release);
+        }
+    );
+
+    const auto request {makeMessage(MessageIds::message_request, payload_size)};
+
+    std::vector<double> round_trip_times;
+
+    round_trip_times.reserve(round_trips_count);
+
+    for(std::size_t i {0}; i < warmup_round_trips_count + round_trips_count; ++i)
+    {
+        const auto start {Clock::now()};
+
+        client->server->send(request);
+
+        // Spinning: sleeping would dominate loopback round trips
+        while(responses_count.load(std::memory_order_acquire) == i)
+        {
+        }
+
+        if(i >= warmup_round_trips_count)
+        {
+            round_trip_times.push_back(toSeconds(Clock::now() - start) * 1e6);
+        }
+    }
+
+    std::ranges::sort(round_trip_times);
+
+    printResult(
+        "echo_latency",
+        std::format(
+            "\"dispatch\": \"{}\", \"payload_bytes\": {}, \"round_trips\": {}, "
+            "\"p50_us\": {:.2f}, \"p90_us\": {:.2f}, \"p99_us\": {:.2f}, \"p999_us\": {:.2f}, \"max_us\": {:.2f}",
+            dispatch == nets::HandlerDispatch::inline_strand ? "inline_strand" : "worker_pool",
+            payload_size,
+            round_trip_times.size(),
+            getPercentile(round_trip_times, 0.5),
+            getPercentile(round_trip_times, 0.9),
+            getPercentile(round_trip_times, 0.99),
+            getPercentile(round_trip_times, 0.999),
+            round_trip_times.back()
+        )
+    );
+
+    client->disconnect();
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 100};
+
+    for(const auto dispatch : {nets::HandlerDispatch::inline_strand, nets::HandlerDispatch::worker_pool})
+    {
+        for(const std::size_t payload_size : {16, 1024, 16 * 1024})
+        {
+            run(dispatch, payload_size, port++);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include "common.hpp"
+
+#include <atomic>
+
+// Many clients streaming messages to one server at once: aggregate messages per second
+// against the number of clients, the server running one io thread per core,
+// then against the number of the server's io threads, for a fixed number of clients
+
+constexpr std::size_t payload_size        {128};
+constexpr std::size_t messages_per_run    {1'000'000};
+
+void run(const std::size_t clients_count, const std::size_t io_threads_count, const nets::Port port)
+{
+    // Outlives the server and the clients, whose handlers count into it
+    std::atomic_size_t received_count {0};
+
+    const auto server {makeServer(port, io_threads_count)};
+
+    server->setHandlerDispatch(nets::HandlerDispatch::inline_strand);
+
+    std::vector<std::unique_ptr<BenchmarkClient>> clients;
+
+    for(std::size_t i {0}; i < clients_count; ++i)
+    {
+        auto& client {*clients.emplace_back(makeClient(port))};
+
+        client.server->setOutgoingQueueLimits(4 * 1024 * 1024, 50'000);
+        client.server->setBackpressurePolicy(nets::BackpressurePolicy::block);
+
+        if(!client.connect())
+        {
+            printResult("fan_in", "\"error\": \"connection failed\"");
+
+            return;
+        }
+    }
+
+    if(!waitFor([&]{ return server->getClientsCount() == clients_count; }))
+    {
+        printResult("fan_in", "\"error\": \"connection failed\"");
+
+        return;
+    }
+
+    for(const auto& server_client : *server->getClients())
+    {
+        server_client->setOnReceivingView(
+            MessageIds::message_request,
+            [&](nets::MessageView message, nets::TcpRemote<MessageIds>&)
+            {
+                received_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        );
+    }
+
+    const auto messages_per_client {messages_per_run / clients_count};
+    const auto messages_count      {messages_per_client * clients_count};
+
+    const auto message {makeMessage(MessageIds::message_request, payload_size)};
+
+    const auto start {Clock::now()};
+
+    {
+        std::vector<std::jthread> sending_threads;
+
+        for(const auto& client : clients)
+        {
+            sending_threads.emplace_back(
+                [&, client = client.get()]
+                {
+                    for(std::size_t i {0}; i < messages_per_client; ++i)
+                    {
+                        client->server->send(message);
+                    }
+                }
+            );
+        }
+    }
+
+    const auto completed {
+        waitFor([&]{ return received_count.load(std::memory_order_relaxed) == messages_count; })
+    };
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "fan_in",
+        std::format(
+            "\"clients\": {}, \"io_threads\": {}, \"payload_bytes\": {}, \"messages\": {}, \"completed\": {}, \"seconds\": {:.4f}, \"messages_per_second\": {:.0f}",
+            clients_count,
+            io_threads_count,
+            payload_size,
+            received_count.load(),
+            completed,
+            elapsed,
+            received_count.load() / elapsed
+        )
+    );
+
+    for(const auto& client : clients)
+    {
+        client->disconnect();
+    }
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 300};
+
+    const auto cores_count {std::max<std::size_t>(std::thread::hardware_concurrency(), 1)};
+
+    for(const std::size_t clients_count : {1, 4, 16, 64})
+    {
+        run(clients_count, cores_count, port++);
+    }
+
+    // Scaling of the server's io_context thread pool
+    for(std::size_t io_threads_count {1}; io_threads_count < cores_count; io_threads_count *= 2)
+    {
+        run(64, io_threads_count, port++);
+    }
+}
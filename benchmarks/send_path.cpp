@@ -0,0 +1,96 @@
+#include "common.hpp"
+
+#include <atomic>
+
+// Cost of send() when the caller's message is copied into the queue versus moved into it.
+// Each iteration builds a fresh message, as a caller sending computed data would, then either
+// passes it as an lvalue (copied) or as an rvalue (moved). Measures the time the sending thread
+// spends queuing, then the time until the server has received every message.
+// The queue is bounded above what a run sends, so that queuing never waits for the socket
+
+constexpr std::size_t bytes_per_run        {32 * 1024 * 1024};
+constexpr std::size_t max_messages_per_run {200'000};
+
+void run(const bool is_moved, const std::size_t payload_size, const nets::Port port)
+{
+    // Outlives the server and the clients, whose handlers count into it
+    std::atomic_size_t received_count {0};
+
+    const auto server {makeServer(port)};
+
+    server->setHandlerDispatch(nets::HandlerDispatch::inline_strand);
+
+    const auto client {makeClient(port)};
+
+    client->server->setOutgoingQueueLimits(2 * bytes_per_run, 2 * max_messages_per_run);
+    client->server->setBackpressurePolicy(nets::BackpressurePolicy::block);
+
+    if(!client->connect() || !waitFor([&]{ return server->getClientsCount() == 1; }))
+    {
+        printResult("send_path", "\"error\": \"connection failed\"");
+
+        return;
+    }
+
+    server->getClients()->front()->setOnReceivingView(
+        MessageIds::message_request,
+        [&](nets::MessageView message, nets::TcpRemote<MessageIds>&)
+        {
+            received_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    );
+
+    const auto messages_count {std::clamp<std::size_t>(bytes_per_run / payload_size, 100, max_messages_per_run)};
+
+    const auto start {Clock::now()};
+
+    for(std::size_t i {0}; i < messages_count; ++i)
+    {
+        auto message {makeMessage(MessageIds::message_request, payload_size)};
+
+        if(is_moved)
+        {
+            client->server->send(std::move(message));
+        }
+        else 
+        {
+            client->server->send(message);
+        }
+    }
+
+    const auto queuing_elapsed {toSeconds(Clock::now() - start)};
+
+    const auto completed {
+        waitFor([&]{ return received_count.load(std::memory_order_relaxed) == messages_count; })
+    };
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "send_path",
+        std::format(
+            "\"kind\": \"{}\", \"payload_bytes\": {}, \"messages\": {}, \"completed\": {}, "
+            "\"ns_per_send\": {:.1f}, \"seconds\": {:.4f}, \"messages_per_second\": {:.0f}",
+            is_moved ? "move" : "copy",
+            payload_size,
+            received_count.load(),
+            completed,
+            queuing_elapsed * 1e9 / static_cast<double>(messages_count),
+            elapsed,
+            received_count.load() / elapsed
+        )
+    );
+
+    client->disconnect();
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 600};
+
+    for(const std::size_t payload_size : {64, 4 * 1024, 64 * 1024})
+    {
+        run(false, payload_size, port++);
+        run(true,  payload_size, port++);
+    }
+}
@@ -0,0 +1,91 @@
+#include "common.hpp"
+
+#include <atomic>
+
+// One-way throughput over a payload sizes sweep: a single client streams messages to the server,
+// the rate being taken once the server has received all of them.
+// The client's outgoing queue is bounded with the block policy, so sending is paced by the socket.
+// Each size is run with write coalescing, then with a single message per write to compare against
+
+constexpr std::size_t bytes_per_run {256 * 1024 * 1024};
+constexpr std::size_t max_messages_per_run {1'000'000};
+
+void run(const std::size_t payload_size, const bool is_coalescing, const nets::Port port)
+{
+    // Outlives the server and the clients, whose handlers count into it
+    std::atomic_size_t received_count {0};
+
+    const auto server {makeServer(port)};
+
+    server->setHandlerDispatch(nets::HandlerDispatch::inline_strand);
+
+    const auto client {makeClient(port)};
+
+    client->server->setOutgoingQueueLimits(16 * 1024 * 1024, 100'000);
+    client->server->setBackpressurePolicy(nets::BackpressurePolicy::block);
+
+    if(!is_coalescing)
+    {
+        client->server->setWriteBatchLimits(256 * 1024, 1);
+    }
+
+    if(!client->connect() || !waitFor([&]{ return server->getClientsCount() == 1; }))
+    {
+        printResult("throughput", "\"error\": \"connection failed\"");
+
+        return;
+    }
+
+    server->getClients()->front()->setOnReceivingView(
+        MessageIds::message_request,
+        [&](nets::MessageView message, nets::TcpRemote<MessageIds>&)
+        {
+            received_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    );
+
+    const auto messages_count {std::clamp<std::size_t>(bytes_per_run / std::max<std::size_t>(payload_size, 1), 100, max_messages_per_run)};
+
+    const auto message {makeMessage(MessageIds::message_request, payload_size)};
+
+    const auto start {Clock::now()};
+
+    for(std::size_t i {0}; i < messages_count; ++i)
+    {
+        client->server->send(message);
+    }
+
+    const auto completed {
+        waitFor([&]{ return received_count.load(std::memory_order_relaxed) == messages_count; })
+    };
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "throughput",
+        std::format(
+            "\"coalescing\": {}, \"payload_bytes\": {}, \"messages\": {}, \"completed\": {}, \"seconds\": {:.4f}, "
+            "\"messages_per_second\": {:.0f}, \"megabytes_per_second\": {:.1f}",
+            is_coalescing,
+            payload_size,
+            received_count.load(),
+            completed,
+            elapsed,
+            received_count.load() / elapsed,
+            received_count.load() * payload_size / elapsed / (1024 * 1024)
+        )
+    );
+
+    client->disconnect();
+}
+
+int main()
+{
+    nets::Port port {benchmarks_base_port + 200};
+
+    for(std::size_t payload_size {16}; payload_size <= 1024 * 1024; payload_size *= 4)
+    {
+        run(payload_size, true,  port++);
+        run(payload_size, false, port++);
+    }
+}
@@ -0,0 +1,107 @@
+#include "common.hpp"
+
+#include <ctime>
+
+// Connection timers at scale: one timeout per connection is armed, then cancelled and armed again
+// as if each connection saw activity, comparing the shared timer wheel to a steady_timer per connection.
+// Then measures the CPU time the wheel's ticking takes while every timer is armed
+
+constexpr std::size_t rearms_per_timer {10};
+
+void runSteadyTimers(const std::size_t timers_count)
+{
+    boost::asio::io_context io_context;
+
+    std::vector<boost::asio::steady_timer> timers;
+
+    timers.reserve(timers_count);
+
+    const auto start {Clock::now()};
+
+    for(std::size_t i {0}; i < timers_count; ++i)
+    {
+        timers.emplace_back(io_context);
+    }
+
+    for(std::size_t rearm {0}; rearm < rearms_per_timer; ++rearm)
+    {
+        for(auto& timer : timers)
+        {
+            // Cancels the pending wait, as a connection's activity would
+            timer.expires_after(std::chrono::seconds{30});
+
+            timer.async_wait([](const boost::system::error_code){});
+        }
+
+        // Runs the cancelled waits' handlers
+        io_context.poll();
+        io_context.restart();
+    }
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    printResult(
+        "timers",
+        std::format(
+            "\"kind\": \"steady_timer\", \"timers\": {}, \"arms\": {}, \"seconds\": {:.4f}, \"ns_per_arm\": {:.1f}",
+            timers_count,
+            timers_count * rearms_per_timer,
+            elapsed,
+            elapsed * 1e9 / static_cast<double>(timers_count * rearms_per_timer)
+        )
+    );
+}
+
+void runTimerWheel(const std::size_t timers_count)
+{
+    boost::asio::io_context io_context;
+
+    auto& timer_wheel {boost::asio::use_service<nets::TimerWheel>(io_context)};
+
+    std::vector<nets::TimerWheel::TimerHandle> timers(timers_count);
+
+    const auto executor {io_context.get_executor()};
+
+    const auto start {Clock::now()};
+
+    for(std::size_t rearm {0}; rearm < rearms_per_timer; ++rearm)
+    {
+        for(auto& timer : timers)
+        {
+            timer_wheel.cancel(timer);
+
+            timer = timer_wheel.arm(std::chrono::seconds{30}, executor, []{});
+        }
+    }
+
+    const auto elapsed {toSeconds(Clock::now() - start)};
+
+    // Ticks for a second with every timer armed, measuring the thread's CPU time
+    const auto cpu_start {std::clock()};
+
+    io_context.run_for(std::chrono::seconds{1});
+
+    const auto ticking_cpu_seconds {static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC};
+
+    printResult(
+        "timers",
+        std::format(
+            "\"kind\": \"timer_wheel\", \"timers\": {}, \"arms\": {}, \"seconds\": {:.4f}, \"ns_per_arm\": {:.1f}, "
+            "\"ticking_cpu_seconds_per_second\": {:.4f}",
+            timers_count,
+            timers_count * rearms_per_timer,
+            elapsed,
+            elapsed * 1e9 / static_cast<double>(timers_count * rearms_per_timer),
+            ticking_cpu_seconds
+        )
+    );
+}
+
+int main()
+{
+    for(const std::size_t timers_count : {1'000, 10'000, 100'000})
+    {
+        runSteadyTimers(timers_count);
+        runTimerWheel(timers_count);
+    }
+}
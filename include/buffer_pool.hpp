@@ -0,0 +1,198 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/smart_ptr/intrusive_ptr.hpp>
+
+namespace nets
+{
+    class BufferPool;
+
+    // Byte buffer handed out by a BufferPool; goes back to its pool when the
+    // last reference to it is released
+    class PooledBuffer
+    {
+        public:
+            std::byte*       getData();
+            const std::byte* getData() const;
+
+            std::size_t getSize() const;
+
+            void resize(const std::size_t size);
+
+            std::size_t getReferencesCount() const;
+
+        private:
+            friend class BufferPool;
+
+            friend void intrusive_ptr_add_ref(PooledBuffer* buffer);
+            friend void intrusive_ptr_release(PooledBuffer* buffer);
+
+            std::vector<std::byte> bytes;
+
+            std::atomic_size_t references {0};
+
+            // Weak, so cached buffers don't keep their pool alive
+            std::weak_ptr<BufferPool> pool;
+    };
+
+    using PooledBufferPtr = boost::intrusive_ptr<PooledBuffer>;
+
+    // Recycles receive buffers, so that steady-state receiving doesn't allocate.
+    // Must be owned by a std::shared_ptr
+    class BufferPool : public std::enable_shared_from_this<BufferPool>
+    {
+        public:
+            BufferPool(
+                const std::size_t max_cached_buffers     = 1024,
+                const std::size_t max_cached_buffer_size = 1024 * 1024
+            );
+
+            BufferPool(const BufferPool&) = delete;
+
+            BufferPool& operator=(const BufferPool&) = delete;
+
+            ~BufferPool();
+
+            // Returns a buffer of `size` bytes, reusing a cached one when available
+            PooledBufferPtr acquire(const std::size_t size);
+
+            std::size_t getCachedBuffersCount() const;
+
+        private:
+            friend void intrusive_ptr_release(PooledBuffer* buffer);
+
+            mutable std::mutex mutex;
+
+            std::vector<PooledBuffer*> cached_buffers;
+
+            std::size_t max_cached_buffers;
+            std::size_t max_cached_buffer_size;
+
+            void recycle(PooledBuffer* buffer);
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    inline std::byte* PooledBuffer::getData()
+    {
+        return bytes.data();
+    }
+
+    inline const std::byte* PooledBuffer::getData() const
+    {
+        return bytes.data();
+    }
+
+    inline std::size_t PooledBuffer::getSize() const
+    {
+        return bytes.size();
+    }
+
+    inline void PooledBuffer::resize(const std::size_t size)
+    {
+        bytes.resize(size);
+    }
+
+    inline std::size_t PooledBuffer::getReferencesCount() const
+    {
+        return references.load(std::memory_order_acquire);
+    }
+
+    inline void intrusive_ptr_add_ref(PooledBuffer* buffer)
+    {
+        buffer->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline void intrusive_ptr_release(PooledBuffer* buffer)
+    {
+        if(buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            if(const auto pool {buffer->pool.lock()})
+            {
+                pool->recycle(buffer);
+            }
+            else
+            {
+                delete buffer;
+            }
+        }
+    }
+
+    inline BufferPool::BufferPool(
+        const std::size_t max_cached_buffers,
+        const std::size_t max_cached_buffer_size
+    )
+    :
+        max_cached_buffers{max_cached_buffers},
+        max_cached_buffer_size{max_cached_buffer_size}
+    {
+        cached_buffers.reserve(max_cached_buffers);
+    }
+
+    inline BufferPool::~BufferPool()
+    {
+        for(auto buffer : cached_buffers)
+        {
+            delete buffer;
+        }
+    }
+
+    inline PooledBufferPtr BufferPool::acquire(const std::size_t size)
+    {
+        PooledBuffer* buffer {nullptr};
+
+        {
+            const std::lock_guard lock {mutex};
+
+            if(!cached_buffers.empty())
+            {
+                buffer = cached_buffers.back();
+
+                cached_buffers.pop_back();
+            }
+        }
+
+        if(!buffer)
+        {
+            buffer = new PooledBuffer;
+
+            buffer->pool = weak_from_this();
+        }
+
+        buffer->resize(size);
+
+        return PooledBufferPtr{buffer};
+    }
+
+    inline std::size_t BufferPool::getCachedBuffersCount() const
+    {
+        const std::lock_guard lock {mutex};
+
+        return cached_buffers.size();
+    }
+
+    inline void BufferPool::recycle(PooledBuffer* buffer)
+    {
+        if(buffer->bytes.capacity() <= max_cached_buffer_size)
+        {
+            const std::lock_guard lock {mutex};
+
+            if(cached_buffers.size() < max_cached_buffers)
+            {
+                cached_buffers.push_back(buffer);
+
+                return;
+            }
+        }
+
+        delete buffer;
+    }
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "types.hpp"
+
+namespace nets
+{
+    // Connected clients keyed by connection id, with O(1) insertion, lookup and removal.
+    // Clients are spread over independently locked shards, so connections and disconnections
+    // on different io threads rarely contend. Iteration goes through an immutable snapshot,
+    // rebuilt lazily after the registry changes and shared by every reader until then
+    template <typename Remote, std::size_t shards_count = 16>
+    class ClientRegistry
+    {
+        public:
+            using Clients  = std::vector<std::shared_ptr<Remote>>;
+            using Snapshot = std::shared_ptr<const Clients>;
+
+            void insert(const std::shared_ptr<Remote>& client);
+
+            // Returns the removed client, nullptr if it wasn't registered
+            std::shared_ptr<Remote> erase(const nets::ConnectionId id);
+
+            std::shared_ptr<Remote> find(const nets::ConnectionId id) const;
+
+            // Removes every client, returning them
+            Clients clear();
+
+            std::size_t getSize() const;
+
+            Snapshot getSnapshot() const;
+
+        private:
+            struct Shard
+            {
+                mutable std::shared_mutex mutex;
+
+                std::unordered_map<nets::ConnectionId, std::shared_ptr<Remote>> clients;
+            };
+
+            std::array<Shard, shards_count> shards;
+
+            std::atomic_size_t   clients_count {0};
+            std::atomic_uint64_t version       {0};
+
+            mutable std::mutex    snapshot_mutex;
+            mutable Snapshot      snapshot {std::make_shared<const Clients>()};
+            mutable std::uint64_t snapshot_version {0};
+
+            // Drops the cached snapshot, to be rebuilt by the next getSnapshot()
+            void resetSnapshot();
+
+            Shard&       getShard(const nets::ConnectionId id);
+            const Shard& getShard(const nets::ConnectionId id) const;
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    template <typename Remote, std::size_t shards_count>
+    void ClientRegistry<Remote, shards_count>::insert(const std::shared_ptr<Remote>& client)
+    {
+        auto& shard {getShard(client->getId())};
+
+        {
+            const std::unique_lock lock {shard.mutex};
+
+            if(!shard.clients.emplace(client->getId(), client).second)
+            {
+                return;
+            }
+        }
+
+        ++clients_count;
+        ++version;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    std::shared_ptr<Remote> ClientRegistry<Remote, shards_count>::erase(const nets::ConnectionId id)
+    {
+        auto& shard {getShard(id)};
+
+        std::shared_ptr<Remote> client;
+
+        {
+            const std::unique_lock lock {shard.mutex};
+
+            const auto client_iter {shard.clients.find(id)};
+
+            if(client_iter == shard.clients.end())
+            {
+                return nullptr;
+            }
+
+            client = std::move(client_iter->second);
+
+            shard.clients.erase(client_iter);
+        }
+
+        --clients_count;
+        ++version;
+
+        // Otherwise the cached snapshot would keep the removed client alive until the next getSnapshot()
+        resetSnapshot();
+
+        return client;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    std::shared_ptr<Remote> ClientRegistry<Remote, shards_count>::find(const nets::ConnectionId id) const
+    {
+        const auto& shard {getShard(id)};
+
+        const std::shared_lock lock {shard.mutex};
+
+        const auto client_iter {shard.clients.find(id)};
+
+        return client_iter != shard.clients.end() ? client_iter->second : nullptr;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    typename ClientRegistry<Remote, shards_count>::Clients ClientRegistry<Remote, shards_count>::clear()
+    {
+        Clients removed_clients;
+
+        for(auto& shard : shards)
+        {
+            const std::unique_lock lock {shard.mutex};
+
+            for(auto& [id, client] : shard.clients)
+            {
+                removed_clients.push_back(std::move(client));
+            }
+
+            clients_count -= shard.clients.size();
+
+            shard.clients.clear();
+        }
+
+        ++version;
+
+        // The cached snapshot would otherwise keep the removed clients alive
+        resetSnapshot();
+
+        return removed_clients;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    std::size_t ClientRegistry<Remote, shards_count>::getSize() const
+    {
+        return clients_count.load(std::memory_order_relaxed);
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    typename ClientRegistry<Remote, shards_count>::Snapshot ClientRegistry<Remote, shards_count>::getSnapshot() const
+    {
+        const std::lock_guard lock {snapshot_mutex};
+
+        const auto current_version {version.load(std::memory_order_acquire)};
+
+        if(snapshot_version != current_version)
+        {
+            auto clients {std::make_shared<Clients>()};
+
+            clients->reserve(getSize());
+
+            for(const auto& shard : shards)
+            {
+                const std::shared_lock shard_lock {shard.mutex};
+
+                for(const auto& [id, client] : shard.clients)
+                {
+                    clients->push_back(client);
+                }
+            }
+
+            snapshot         = std::move(clients);
+            snapshot_version = current_version;
+        }
+
+        return snapshot;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    void ClientRegistry<Remote, shards_count>::resetSnapshot()
+    {
+        const std::lock_guard lock {snapshot_mutex};
+
+        // Stale on purpose: the version has moved on, so the next getSnapshot() rebuilds it
+        snapshot         = std::make_shared<const Clients>();
+        snapshot_version = 0;
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    typename ClientRegistry<Remote, shards_count>::Shard& ClientRegistry<Remote, shards_count>::getShard(
+        const nets::ConnectionId id
+    )
+    {
+        return shards[id % shards_count];
+    }
+
+    template <typename Remote, std::size_t shards_count>
+    const typename ClientRegistry<Remote, shards_count>::Shard& ClientRegistry<Remote, shards_count>::getShard(
+        const nets::ConnectionId id
+    ) const
+    {
+        return shards[id % shards_count];
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+namespace nets
+{
+    // Wraps the completion handler of an asynchronous operation, so that it can be completed
+    // from any thread: the handler is posted to its associated executor (or to `default_executor`),
+    // which is kept busy until then
+    template <typename... Args, typename Handler>
+    std::move_only_function<void(Args...)> makeCompletion(
+        Handler                             handler,
+        const boost::asio::any_io_executor& default_executor
+    );
+}
+
+// Implementation
+
+namespace nets
+{
+    template <typename... Args, typename Handler>
+    std::move_only_function<void(Args...)> makeCompletion(
+        Handler                             handler,
+        const boost::asio::any_io_executor& default_executor
+    )
+    {
+        const auto executor {boost::asio::get_associated_executor(handler, default_executor)};
+
+        return [
+            handler = std::move(handler),
+            work    = boost::asio::make_work_guard(executor),
+            executor
+        ]
+        (Args... args) mutable
+        {
+            boost::asio::post(
+                executor,
+                [handler = std::move(handler), ...args = std::move(args)]() mutable
+                {
+                    handler(std::move(args)...);
+                }
+            );
+        };
+    }
+}
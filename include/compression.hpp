@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#if defined(NETS_WITH_LZ4)
+    #include <lz4.h>
+#endif
+
+#if defined(NETS_WITH_ZSTD)
+    #include <zstd.h>
+#endif
+
+namespace nets
+{
+    using CompressionCodecId = std::uint8_t;
+
+    // Compresses message payloads. Remotes announce the ids of the codecs they have to their peer,
+    // so ids must identify the same algorithm on both sides.
+    // Codecs are shared by remotes and used concurrently, so they must be stateless or thread-safe
+    class CompressionCodec
+    {
+        public:
+            virtual ~CompressionCodec() = default;
+
+            virtual CompressionCodecId getId() const = 0;
+
+            // Worst-case size of the compressed input
+            virtual std::size_t getMaxCompressedSize(const std::size_t size) const = 0;
+
+            // Returns the compressed size, 0 on failure
+            virtual std::size_t compress(
+                std::span<const std::byte> input,
+                std::span<std::byte>       output
+            ) const = 0;
+
+            // The output is exactly as large as the uncompressed data. Returns false on corrupted input
+            virtual bool decompress(
+                std::span<const std::byte> input,
+                std::span<std::byte>       output
+            ) const = 0;
+    };
+
+#if defined(NETS_WITH_LZ4)
+    // Fast, with a moderate ratio
+    class Lz4Codec : public CompressionCodec
+    {
+        public:
+            static constexpr CompressionCodecId id {1};
+
+            CompressionCodecId getId() const override;
+
+            std::size_t getMaxCompressedSize(const std::size_t size) const override;
+
+            std::size_t compress  (std::span<const std::byte> input, std::span<std::byte> output) const override;
+            bool        decompress(std::span<const std::byte> input, std::span<std::byte> output) const override;
+    };
+#endif
+
+#if defined(NETS_WITH_ZSTD)
+    // Better ratio than LZ4 at a higher CPU cost, tunable through its level
+    class ZstdCodec : public CompressionCodec
+    {
+        public:
+            static constexpr CompressionCodecId id {2};
+
+            ZstdCodec(const int level = 1);
+
+            CompressionCodecId getId() const override;
+
+            std::size_t getMaxCompressedSize(const std::size_t size) const override;
+
+            std::size_t compress  (std::span<const std::byte> input, std::span<std::byte> output) const override;
+            bool        decompress(std::span<const std::byte> input, std::span<std::byte> output) const override;
+
+        private:
+            int level;
+    };
+#endif
+}
+
+// Implementation
+
+namespace nets
+{
+#if defined(NETS_WITH_LZ4)
+    inline CompressionCodecId Lz4Codec::getId() const
+    {
+        return id;
+    }
+
+    inline std::size_t Lz4Codec::getMaxCompressedSize(const std::size_t size) const
+    {
+        return static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(size)));
+    }
+
+    inline std::size_t Lz4Codec::compress(std::span<const std::byte> input, std::span<std::byte> output) const
+    {
+        const auto compressed_size {
+            LZ4_compress_default(
+                reinterpret_cast<const char*>(input.data()),
+                reinterpret_cast<char*>(output.data()),
+                static_cast<int>(input.size()),
+                static_cast<int>(output.size())
+            )
+        };
+
+        return compressed_size > 0 ? static_cast<std::size_t>(compressed_size) : 0;
+    }
+
+    inline bool Lz4Codec::decompress(std::span<const std::byte> input, std::span<std::byte> output) const
+    {
+        const auto decompressed_size {
+            LZ4_decompress_safe(
+                reinterpret_cast<const char*>(input.data()),
+                reinterpret_cast<char*>(output.data()),
+                static_cast<int>(input.size()),
+                static_cast<int>(output.size())
+            )
+        };
+
+        return decompressed_size >= 0 && static_cast<std::size_t>(decompressed_size) == output.size();
+    }
+#endif
+
+#if defined(NETS_WITH_ZSTD)
+    inline ZstdCodec::ZstdCodec(const int level)
+    :
+        level{level}
+    {}
+
+    inline CompressionCodecId ZstdCodec::getId() const
+    {
+        return id;
+    }
+
+    inline std::size_t ZstdCodec::getMaxCompressedSize(const std::size_t size) const
+    {
+        return ZSTD_compressBound(size);
+    }
+
+    inline std::size_t ZstdCodec::compress(std::span<const std::byte> input, std::span<std::byte> output) const
+    {
+        // Contexts are expensive to create: one per thread is reused
+        thread_local const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context {
+            ZSTD_createCCtx(), &ZSTD_freeCCtx
+        };
+
+        const auto compressed_size {
+            ZSTD_compressCCtx(
+                context.get(),
+                output.data(), output.size(),
+                input.data(),  input.size(),
+                level
+            )
+        };
+
+        return ZSTD_isError(compressed_size) ? 0 : compressed_size;
+    }
+
+    inline bool ZstdCodec::decompress(std::span<const std::byte> input, std::span<std::byte> output) const
+    {
+        thread_local const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context {
+            ZSTD_createDCtx(), &ZSTD_freeDCtx
+        };
+
+        const auto decompressed_size {
+            ZSTD_decompressDCtx(
+                context.get(),
+                output.data(), output.size(),
+                input.data(),  input.size()
+            )
+        };
+
+        return !ZSTD_isError(decompressed_size) && decompressed_size == output.size();
+    }
+#endif
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include "collection.hpp"
+#include "message_view.hpp"
+
+namespace nets
+{
+    // Frames are [version and flags][message id][body size][body], the id and the size being varints.
+    // The id is taken out of the message, so frames can be routed, filtered or dropped from their header alone
+    constexpr std::uint8_t frame_version {1};
+
+    // Low bits of a frame's first byte, the high ones being its version
+    using FrameFlags = std::uint8_t;
+
+    // The body is [codec id][uncompressed size][compressed body]
+    constexpr FrameFlags frame_compressed_flag {0x01};
+
+    // The body is [control frame type][data], handled by the library. The message id is 0
+    constexpr FrameFlags frame_control_flag {0x02};
+
+    // Reserved: neither sent nor handled yet, such frames are dropped
+    constexpr FrameFlags frame_chunked_flag  {0x04};
+    constexpr FrameFlags frame_priority_flag {0x08};
+
+    // The body is [correlation][body], the correlation being a varint (see encodeCorrelation()).
+    // Applies before the other flags: a compressed request's body is [correlation][codec id]...
+    constexpr FrameFlags frame_correlated_flag {0x10};
+
+    constexpr unsigned   frame_version_shift {5};
+    constexpr FrameFlags frame_flags_mask    {(1 << frame_version_shift) - 1};
+
+    constexpr std::size_t max_varint_size {10};
+
+    constexpr std::size_t max_frame_header_size {1 + 2 * max_varint_size};
+
+    constexpr std::size_t max_frame_size {std::numeric_limits<mdsm::Collection::Size>::max()};
+
+    // Largest frame a remote accepts by default (see TcpRemote::setMaxReceivedFrameSize())
+    constexpr std::size_t default_max_received_frame_size {64 * 1024 * 1024};
+
+    enum class ControlFrame : std::uint8_t
+    {
+        // [ids count][codec ids...]: the compression codecs the sender can decompress
+        codecs_announcement
+    };
+
+    // What a correlated frame is to the request it refers to
+    enum class CorrelationKind : std::uint8_t
+    {
+        request, response,
+
+        // Sent back instead of a response when the receiver has no handler for the request's id
+        unhandled
+    };
+
+    struct FrameHeader
+    {
+        // Followed by the correlation of correlated frames
+        std::array<std::byte, max_frame_header_size + max_varint_size> bytes;
+        std::size_t                                  size {0};
+
+        const std::byte* getData() const;
+        std::size_t      getSize() const;
+    };
+
+    struct DecodedFrameHeader
+    {
+        std::uint8_t  version    {0};
+        FrameFlags    flags      {0};
+        std::uint64_t message_id {0};
+        std::size_t   body_size  {0};
+
+        // Bytes taken by the header itself
+        std::size_t size {0};
+    };
+
+    enum class FrameHeaderStatus
+    {
+        complete, incomplete, malformed
+    };
+
+    // LEB128: 7 bits per byte, least significant first. Returns how many bytes were written
+    std::size_t encodeVarint(std::uint64_t value, std::byte* output);
+
+    std::size_t getVarintSize(std::uint64_t value);
+
+    // Returns how many bytes were read, 0 if the varint isn't complete yet
+    // or std::nullopt if it's longer than max_varint_size
+    std::optional<std::size_t> decodeVarint(std::span<const std::byte> input, std::uint64_t& value);
+
+    void encodeFrameHeader(
+        const std::uint64_t message_id,
+        const std::size_t   body_size,
+        const FrameFlags    flags,
+        FrameHeader&        header
+    );
+
+    // The correlation of a correlated frame is written after the header, and counted in its body size
+    void encodeFrameHeader(
+        const std::uint64_t message_id,
+        const std::size_t   body_size,
+        const FrameFlags    flags,
+        const std::uint64_t correlation,
+        FrameHeader&        header
+    );
+
+    FrameHeaderStatus decodeFrameHeader(std::span<const std::byte> input, DecodedFrameHeader& header);
+
+    std::size_t getFrameSize(const std::uint64_t message_id, const std::size_t body_size);
+
+    // The request id is shifted left to make room for the kind: requests and their responses share it
+    std::uint64_t encodeCorrelation(const std::uint64_t request_id, const CorrelationKind kind);
+
+    std::uint64_t   getCorrelationRequestId(const std::uint64_t correlation);
+    CorrelationKind getCorrelationKind     (const std::uint64_t correlation);
+
+    template <typename MessageIdEnum>
+    std::uint64_t toWireMessageId(const MessageIdEnum message_id);
+
+    template <typename MessageIdEnum>
+    MessageIdEnum fromWireMessageId(const std::uint64_t message_id);
+
+    // Immutable message framed once, which can be queued by many remotes at the cost of a reference count
+    class SharedFrame
+    {
+        public:
+            // The body is what follows the first `body_offset` bytes of the message (its id)
+            SharedFrame(
+                mdsm::Collection    message,
+                const std::uint64_t message_id,
+                const std::size_t   body_offset
+            );
+
+            const mdsm::Collection&    getMessage()   const;
+            const FrameHeader&         getHeader()    const;
+            std::span<const std::byte> getBody()      const;
+            std::uint64_t              getMessageId() const;
+
+        private:
+            mdsm::Collection message;
+            FrameHeader      header;
+            std::uint64_t    message_id;
+            std::size_t      body_offset;
+    };
+
+    using SharedFramePtr = std::shared_ptr<const SharedFrame>;
+
+    // The id is taken out of the message: nullptr if the message is too short to hold one
+    template <typename MessageIdEnum>
+    SharedFramePtr makeSharedFrame(mdsm::Collection message);
+}
+
+// Implementation
+
+namespace nets
+{
+    inline const std::byte* FrameHeader::getData() const
+    {
+        return bytes.data();
+    }
+
+    inline std::size_t FrameHeader::getSize() const
+    {
+        return size;
+    }
+
+    inline std::size_t encodeVarint(std::uint64_t value, std::byte* output)
+    {
+        std::size_t size {0};
+
+        while(value >= 0x80)
+        {
+            output[size++] = static_cast<std::byte>((value & 0x7f) | 0x80);
+
+            value >>= 7;
+        }
+
+        output[size++] = static_cast<std::byte>(value);
+
+        return size;
+    }
+
+    inline std::size_t getVarintSize(std::uint64_t value)
+    {
+        std::size_t size {1};
+
+        while(value >= 0x80)
+        {
+            value >>= 7;
+
+            ++size;
+        }
+
+        return size;
+    }
+
+    inline std::optional<std::size_t> decodeVarint(std::span<const std::byte> input, std::uint64_t& value)
+    {
+        value = 0;
+
+        for(std::size_t i {0}; i < input.size(); ++i)
+        {
+            if(i == max_varint_size)
+            {
+                return std::nullopt;
+            }
+
+            const auto byte {std::to_integer<std::uint64_t>(input[i])};
+
+            value |= (byte & 0x7f) << (7 * i);
+
+            if((byte & 0x80) == 0)
+            {
+                return i + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    inline void encodeFrameHeader(
+        const std::uint64_t message_id,
+        const std::size_t   body_size,
+        const FrameFlags    flags,
+        FrameHeader&        header
+    )
+    {
+        header.bytes[0] = static_cast<std::byte>((frame_version << frame_version_shift) | (flags & frame_flags_mask));
+
+        header.size  = 1;
+        header.size += encodeVarint(message_id, header.bytes.data() + header.size);
+        header.size += encodeVarint(body_size,  header.bytes.data() + header.size);
+    }
+
+    inline void encodeFrameHeader(
+        const std::uint64_t message_id,
+        const std::size_t   body_size,
+        const FrameFlags    flags,
+        const std::uint64_t correlation,
+        FrameHeader&        header
+    )
+    {
+        if(!(flags & frame_correlated_flag))
+        {
+            encodeFrameHeader(message_id, body_size, flags, header);
+
+            return;
+        }
+
+        encodeFrameHeader(message_id, getVarintSize(correlation) + body_size, flags, header);
+
+        header.size += encodeVarint(correlation, header.bytes.data() + header.size);
+    }
+
+    inline FrameHeaderStatus decodeFrameHeader(std::span<const std::byte> input, DecodedFrameHeader& header)
+    {
+        if(input.empty())
+        {
+            return FrameHeaderStatus::incomplete;
+        }
+
+        const auto first_byte {std::to_integer<std::uint8_t>(input[0])};
+
+        header.version = first_byte >> frame_version_shift;
+        header.flags   = first_byte &  frame_flags_mask;
+
+        if(header.version != frame_version)
+        {
+            return FrameHeaderStatus::malformed;
+        }
+
+        const auto message_id_size {decodeVarint(input.subspan(1), header.message_id)};
+
+        if(!message_id_size)
+        {
+            return FrameHeaderStatus::malformed;
+        }
+        else if(*message_id_size == 0)
+        {
+            return FrameHeaderStatus::incomplete;
+        }
+
+        std::uint64_t body_size {0};
+
+        const auto body_size_size {decodeVarint(input.subspan(1 + *message_id_size), body_size)};
+
+        if(!body_size_size)
+        {
+            return FrameHeaderStatus::malformed;
+        }
+        else if(*body_size_size == 0)
+        {
+            return FrameHeaderStatus::incomplete;
+        }
+        else if(body_size > max_frame_size)
+        {
+            return FrameHeaderStatus::malformed;
+        }
+
+        header.body_size = static_cast<std::size_t>(body_size);
+        header.size      = 1 + *message_id_size + *body_size_size;
+
+        return FrameHeaderStatus::complete;
+    }
+
+    inline std::size_t getFrameSize(const std::uint64_t message_id, const std::size_t body_size)
+    {
+        return 1 + getVarintSize(message_id) + getVarintSize(body_size) + body_size;
+    }
+
+    inline std::uint64_t encodeCorrelation(const std::uint64_t request_id, const CorrelationKind kind)
+    {
+        return (request_id << 2) | static_cast<std::uint64_t>(kind);
+    }
+
+    inline std::uint64_t getCorrelationRequestId(const std::uint64_t correlation)
+    {
+        return correlation >> 2;
+    }
+
+    inline CorrelationKind getCorrelationKind(const std::uint64_t correlation)
+    {
+        return static_cast<CorrelationKind>(correlation & 0x03);
+    }
+
+    template <typename MessageIdEnum>
+    std::uint64_t toWireMessageId(const MessageIdEnum message_id)
+    {
+        return static_cast<std::make_unsigned_t<std::underlying_type_t<MessageIdEnum>>>(message_id);
+    }
+
+    template <typename MessageIdEnum>
+    MessageIdEnum fromWireMessageId(const std::uint64_t message_id)
+    {
+        return static_cast<MessageIdEnum>(message_id);
+    }
+
+    inline SharedFrame::SharedFrame(
+        mdsm::Collection    t_message,
+        const std::uint64_t message_id,
+        const std::size_t   body_offset
+    )
+    :
+        message{std::move(t_message)},
+        message_id{message_id},
+        body_offset{body_offset}
+    {
+        encodeFrameHeader(message_id, message.getSize() - body_offset, 0, header);
+    }
+
+    inline const mdsm::Collection& SharedFrame::getMessage() const
+    {
+        return message;
+    }
+
+    inline const FrameHeader& SharedFrame::getHeader() const
+    {
+        return header;
+    }
+
+    inline std::span<const std::byte> SharedFrame::getBody() const
+    {
+        return {message.getData() + body_offset, message.getSize() - body_offset};
+    }
+
+    inline std::uint64_t SharedFrame::getMessageId() const
+    {
+        return message_id;
+    }
+
+    template <typename MessageIdEnum>
+    SharedFramePtr makeSharedFrame(mdsm::Collection message)
+    {
+        if(message.getSize() < sizeof(MessageIdEnum))
+        {
+            // Malformed message, without id
+            return nullptr;
+        }
+
+        const auto message_id {toWireMessageId(peekMessageId<MessageIdEnum>(message.getData()))};
+
+        return std::make_shared<const SharedFrame>(std::move(message), message_id, sizeof(MessageIdEnum));
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "types.hpp"
+
+namespace nets
+{
+    // Runs message handlers and failure callbacks of the remotes owned by a
+    // server or a client.
+    // In worker_pool mode handlers run on a fixed-size pool, through one strand
+    // per connection, so concurrency is bounded and each connection's
+    // handlers keep their order. In inline_strand mode they run directly on
+    // the connection's own strand.
+    class HandlerDispatcher
+    {
+        public:
+            HandlerDispatcher(
+                const HandlerDispatch mode          = HandlerDispatch::worker_pool,
+                const std::size_t     workers_count = defaultWorkersCount()
+            );
+
+            HandlerDispatcher(const HandlerDispatcher&) = delete;
+
+            HandlerDispatcher& operator=(const HandlerDispatcher&) = delete;
+
+            ~HandlerDispatcher();
+
+            HandlerDispatch getMode()         const;
+            std::size_t     getWorkersCount() const;
+
+            // Returns the executor handlers of a single connection are
+            // dispatched to
+            boost::asio::any_io_executor makeConnectionExecutor(
+                const boost::asio::any_io_executor& connection_executor
+            );
+
+            static std::size_t defaultWorkersCount();
+
+            // Worker pool shared by every holder of the returned pointer: created by the first call,
+            // and joined once the last holder releases it. Thread safe
+            static std::shared_ptr<HandlerDispatcher> getShared();
+
+        private:
+            HandlerDispatch mode;
+            std::size_t     workers_count;
+
+            std::unique_ptr<boost::asio::thread_pool> workers;
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    inline HandlerDispatcher::HandlerDispatcher(
+        const HandlerDispatch mode,
+        const std::size_t     workers_count
+    )
+    :
+        mode{mode},
+        workers_count{mode == HandlerDispatch::worker_pool ? std::max<std::size_t>(workers_count, 1) : 0}
+    {
+        if(mode == HandlerDispatch::worker_pool)
+        {
+            workers = std::make_unique<boost::asio::thread_pool>(this->workers_count);
+        }
+    }
+
+    inline HandlerDispatcher::~HandlerDispatcher()
+    {
+        if(workers)
+        {
+            workers->join();
+        }
+    }
+
+    inline HandlerDispatch HandlerDispatcher::getMode() const
+    {
+        return mode;
+    }
+
+    inline std::size_t HandlerDispatcher::getWorkersCount() const
+    {
+        return workers_count;
+    }
+
+    inline boost::asio::any_io_executor HandlerDispatcher::makeConnectionExecutor(
+        const boost::asio::any_io_executor& connection_executor
+    )
+    {
+        if(mode == HandlerDispatch::worker_pool)
+        {
+            return boost::asio::make_strand(workers->get_executor());
+        }
+        else
+        {
+            return connection_executor;
+        }
+    }
+
+    inline std::size_t HandlerDispatcher::defaultWorkersCount()
+    {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    inline std::shared_ptr<HandlerDispatcher> HandlerDispatcher::getShared()
+    {
+        static std::mutex                       shared_dispatcher_mutex;
+        static std::weak_ptr<HandlerDispatcher> shared_dispatcher;
+
+        const std::lock_guard lock {shared_dispatcher_mutex};
+
+        auto dispatcher {shared_dispatcher.lock()};
+
+        if(!dispatcher)
+        {
+            dispatcher        = std::make_shared<HandlerDispatcher>();
+            shared_dispatcher = dispatcher;
+        }
+
+        return dispatcher;
+    }
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace nets
+{
+    // Number of message ids of a messages enum: detected from a trailing `count` enumerator,
+    // or provided by specializing this trait. Zero means unknown
+    template <typename MessageIdEnum>
+    struct MessageIdsCount
+    {
+        static constexpr std::size_t value {0};
+    };
+
+    template <typename MessageIdEnum>
+        requires requires { MessageIdEnum::count; }
+    struct MessageIdsCount<MessageIdEnum>
+    {
+        static constexpr std::size_t value {static_cast<std::size_t>(MessageIdEnum::count)};
+    };
+
+    // Maps message ids to their handlers.
+    // Lookups and replacements are safe to run concurrently: handlers are swapped atomically,
+    // so a lookup gets either the old or the new handler, which it keeps alive while in use.
+    // When the ids count is known, the table is a fixed-size array indexed by id,
+    // otherwise a hash map guarded by a shared mutex
+    template <typename MessageIdEnum, typename Handler, std::size_t ids_count = MessageIdsCount<MessageIdEnum>::value>
+    class MessageDispatchTable
+    {
+        public:
+            using HandlerPtr = std::shared_ptr<const Handler>;
+
+            void set(const MessageIdEnum message_id, Handler handler, const bool enabled);
+
+            void setEnabled(const MessageIdEnum message_id, const bool enabled);
+
+            // Returns the handler of an enabled message id, nullptr otherwise
+            HandlerPtr find(const MessageIdEnum message_id) const;
+
+        private:
+            struct Slot
+            {
+                std::atomic<HandlerPtr> handler;
+                std::atomic_bool        enabled {false};
+            };
+
+            std::array<Slot, ids_count> slots;
+
+            // Ids received from the network may be out of range
+            static bool isInRange(const MessageIdEnum message_id);
+    };
+
+    template <typename MessageIdEnum, typename Handler>
+    class MessageDispatchTable<MessageIdEnum, Handler, 0>
+    {
+        public:
+            using HandlerPtr = std::shared_ptr<const Handler>;
+
+            void set(const MessageIdEnum message_id, Handler handler, const bool enabled);
+
+            void setEnabled(const MessageIdEnum message_id, const bool enabled);
+
+            HandlerPtr find(const MessageIdEnum message_id) const;
+
+        private:
+            struct Slot
+            {
+                HandlerPtr handler;
+                bool       enabled {false};
+            };
+
+            mutable std::shared_mutex mutex;
+
+            std::unordered_map<MessageIdEnum, Slot> slots;
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    template <typename MessageIdEnum, typename Handler, std::size_t ids_count>
+    void MessageDispatchTable<MessageIdEnum, Handler, ids_count>::set(
+        const MessageIdEnum message_id,
+        Handler             handler,
+        const bool          enabled
+    )
+    {
+        if(isInRange(message_id))
+        {
+            auto& slot {slots[static_cast<std::size_t>(message_id)]};
+
+            slot.handler.store(std::make_shared<const Handler>(std::move(handler)));
+            slot.enabled.store(enabled);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Handler, std::size_t ids_count>
+    void MessageDispatchTable<MessageIdEnum, Handler, ids_count>::setEnabled(
+        const MessageIdEnum message_id,
+        const bool          enabled
+    )
+    {
+        if(isInRange(message_id))
+        {
+            slots[static_cast<std::size_t>(message_id)].enabled.store(enabled);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Handler, std::size_t ids_count>
+    typename MessageDispatchTable<MessageIdEnum, Handler, ids_count>::HandlerPtr
+        MessageDispatchTable<MessageIdEnum, Handler, ids_count>::find(const MessageIdEnum message_id) const
+    {
+        if(!isInRange(message_id))
+        {
+            return nullptr;
+        }
+
+        const auto& slot {slots[static_cast<std::size_t>(message_id)]};
+
+        if(!slot.enabled.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return slot.handler.load(std::memory_order_acquire);
+    }
+
+    template <typename MessageIdEnum, typename Handler, std::size_t ids_count>
+    bool MessageDispatchTable<MessageIdEnum, Handler, ids_count>::isInRange(const MessageIdEnum message_id)
+    {
+        return static_cast<std::size_t>(message_id) < ids_count;
+    }
+
+    template <typename MessageIdEnum, typename Handler>
+    void MessageDispatchTable<MessageIdEnum, Handler, 0>::set(
+        const MessageIdEnum message_id,
+        Handler             handler,
+        const bool          enabled
+    )
+    {
+        auto new_handler {std::make_shared<const Handler>(std::move(handler))};
+
+        const std::unique_lock lock {mutex};
+
+        auto& slot {slots[message_id]};
+
+        slot.handler = std::move(new_handler);
+        slot.enabled = enabled;
+    }
+
+    template <typename MessageIdEnum, typename Handler>
+    void MessageDispatchTable<MessageIdEnum, Handler, 0>::setEnabled(
+        const MessageIdEnum message_id,
+        const bool          enabled
+    )
+    {
+        const std::unique_lock lock {mutex};
+
+        slots[message_id].enabled = enabled;
+    }
+
+    template <typename MessageIdEnum, typename Handler>
+    typename MessageDispatchTable<MessageIdEnum, Handler, 0>::HandlerPtr
+        MessageDispatchTable<MessageIdEnum, Handler, 0>::find(const MessageIdEnum message_id) const
+    {
+        const std::shared_lock lock {mutex};
+
+        const auto slot_iter {slots.find(message_id)};
+
+        if(slot_iter == slots.end() || !slot_iter->second.enabled)
+        {
+            return nullptr;
+        }
+
+        return slot_iter->second.handler;
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+
+#include "buffer_pool.hpp"
+#include "collection.hpp"
+
+namespace nets
+{
+    // Read-only, reference counted view of a received message body (the bytes
+    // following the message id). The underlying buffer goes back to its pool
+    // once every view referring to it is released
+    class MessageView
+    {
+        public:
+            MessageView() = default;
+
+            MessageView(
+                PooledBufferPtr   buffer,
+                const std::size_t offset,
+                const std::size_t size
+            );
+
+            const std::byte* getData() const;
+            std::size_t      getSize() const;
+
+            std::span<const std::byte> getBytes() const;
+
+            // Extracts a value serialized by mdsm::Collection at `offset` bytes from the beginning of the view,
+            // or nothing if the view is too short to hold it
+            template <typename Type>
+            std::optional<Type> read(const std::size_t offset = 0) const;
+
+            // Copies the viewed bytes into a Collection
+            mdsm::Collection toCollection() const;
+
+            void release();
+
+        private:
+            PooledBufferPtr buffer;
+
+            std::size_t offset {0};
+            std::size_t size   {0};
+    };
+
+    // Collection serializes an enum as its underlying bytes at the beginning of the message,
+    // so the id can be read in place
+    template <typename MessageIdEnum>
+    MessageIdEnum peekMessageId(const std::byte* message_data);
+}
+
+// Implementation
+
+namespace nets
+{
+    inline MessageView::MessageView(
+        PooledBufferPtr   buffer,
+        const std::size_t offset,
+        const std::size_t size
+    )
+    :
+        buffer{std::move(buffer)},
+        offset{offset},
+        size{size}
+    {
+    }
+
+    inline const std::byte* MessageView::getData() const
+    {
+        return buffer ? buffer->getData() + offset : nullptr;
+    }
+
+    inline std::size_t MessageView::getSize() const
+    {
+        return size;
+    }
+
+    inline std::span<const std::byte> MessageView::getBytes() const
+    {
+        return {getData(), size};
+    }
+
+    template <typename Type>
+    std::optional<Type> MessageView::read(const std::size_t t_offset) const
+    {
+        if(t_offset > size || size - t_offset < sizeof(Type))
+        {
+            return std::nullopt;
+        }
+
+        return mdsm::Collection::prepareDataForExtracting<Type>(getData() + t_offset);
+    }
+
+    inline mdsm::Collection MessageView::toCollection() const
+    {
+        mdsm::Collection collection;
+
+        collection.resize(size);
+
+        if(size > 0)
+        {
+            std::memcpy(collection.getData(), getData(), size);
+        }
+
+        return collection;
+    }
+
+    inline void MessageView::release()
+    {
+        buffer.reset();
+
+        offset = 0;
+        size   = 0;
+    }
+
+    template <typename MessageIdEnum>
+    MessageIdEnum peekMessageId(const std::byte* message_data)
+    {
+        return mdsm::Collection::prepareDataForExtracting<MessageIdEnum>(message_data);
+    }
+}
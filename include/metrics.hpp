@@ -0,0 +1,604 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nets
+{
+    struct HistogramSnapshot
+    {
+        // Bucket i counts durations below 2^i microseconds (and above the previous bound), the last one the rest
+        static constexpr std::size_t buckets_count {28};
+
+        std::array<std::uint64_t, buckets_count> buckets {};
+
+        std::uint64_t            count {0};
+        std::chrono::nanoseconds sum   {0};
+
+        // Upper bound of a bucket, infinite for the last one
+        static double getBucketBound(const std::size_t bucket);
+
+        // Upper bound of the bucket holding the `quantile` (in [0, 1]) of the samples
+        double getQuantile(const double quantile) const;
+
+        HistogramSnapshot& operator+=(const HistogramSnapshot& histogram);
+    };
+
+    // Durations histogram with power of two buckets, recorded with relaxed atomics
+    class DurationHistogram
+    {
+        public:
+            void record(const std::chrono::nanoseconds duration);
+
+            HistogramSnapshot getSnapshot() const;
+
+        private:
+            std::array<std::atomic_uint64_t, HistogramSnapshot::buckets_count> buckets {};
+
+            std::atomic_int64_t sum_ns {0};
+    };
+
+    // Messages count per wire message id. When the ids count is known, the counters are
+    // a fixed-size array of relaxed atomics, otherwise a hash map guarded by a mutex
+    template <std::size_t ids_count>
+    class MessageCounters
+    {
+        public:
+            void increment(const std::uint64_t message_id);
+
+            // Ids with at least one message, in ascending order
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> getSnapshot() const;
+
+        private:
+            std::array<std::atomic_uint64_t, ids_count> counters {};
+    };
+
+    // Ids are chosen by the peer: past max_tracked_ids distinct ones, messages with new ids
+    // are counted together under other_message_id, so that the map can't grow unbounded
+    template <>
+    class MessageCounters<0>
+    {
+        public:
+            static constexpr std::size_t   max_tracked_ids  {256};
+            static constexpr std::uint64_t other_message_id {std::numeric_limits<std::uint64_t>::max()};
+
+            void increment(const std::uint64_t message_id);
+
+            std::vector<std::pair<std::uint64_t, std::uint64_t>> getSnapshot() const;
+
+        private:
+            mutable std::mutex mutex;
+
+            std::unordered_map<std::uint64_t, std::uint64_t> counters;
+
+            std::uint64_t other_count {0};
+    };
+
+    struct MetricsSnapshot
+    {
+        // Frame bytes, headers included
+        std::uint64_t bytes_received {0};
+        std::uint64_t bytes_sent     {0};
+
+        std::uint64_t messages_received {0};
+        std::uint64_t messages_sent     {0};
+
+        // (Wire message id, messages count)
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> messages_received_by_id;
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> messages_sent_by_id;
+
+        // Outgoing queue depth when the snapshot was taken
+        std::uint64_t queued_bytes    {0};
+        std::uint64_t queued_messages {0};
+
+        // Time spent running message handlers
+        HistogramSnapshot handler_durations;
+
+        HistogramSnapshot ping_round_trip_times;
+
+        MetricsSnapshot& operator+=(const MetricsSnapshot& metrics);
+    };
+
+    // Counters of a remote. Each one is updated with a relaxed atomic operation, so recording
+    // never contends with other connections nor with snapshots
+    template <std::size_t ids_count>
+    class MetricsRecorder
+    {
+        public:
+            void recordReceivedBytes(const std::size_t bytes_count);
+            void recordSentBytes    (const std::size_t bytes_count);
+
+            void recordReceivedMessage(const std::uint64_t message_id);
+            void recordSentMessage    (const std::uint64_t message_id);
+
+            void recordHandlerDuration(const std::chrono::nanoseconds duration);
+            void recordPingTime       (const std::chrono::nanoseconds ping_time);
+
+            // Queue depth isn't recorded here: it's filled in by the remote
+            MetricsSnapshot getSnapshot() const;
+
+        private:
+            std::atomic_uint64_t bytes_received {0};
+            std::atomic_uint64_t bytes_sent     {0};
+
+            MessageCounters<ids_count> messages_received;
+            MessageCounters<ids_count> messages_sent;
+
+            DurationHistogram handler_durations;
+            DurationHistogram ping_round_trip_times;
+    };
+
+    struct ServerMetricsSnapshot
+    {
+        std::uint64_t connections_accepted {0};
+        std::uint64_t connections_closed   {0};
+        std::uint64_t connections_active   {0};
+        std::uint64_t accept_errors        {0};
+
+        // Summed over the connected clients and the ones already closed
+        MetricsSnapshot connections;
+    };
+
+    // Metrics of one connection, with the labels identifying it (such as `connection_id="4"`)
+    struct LabeledMetricsSnapshot
+    {
+        std::string     labels;
+        MetricsSnapshot metrics;
+    };
+
+    // Prometheus text exposition format, each metric having a sample per snapshot
+    std::string formatPrometheus(
+        std::span<const LabeledMetricsSnapshot> metrics,
+        const std::string_view                  prefix = "nets"
+    );
+
+    std::string formatPrometheus(
+        const MetricsSnapshot& metrics,
+        const std::string_view labels = "",
+        const std::string_view prefix = "nets"
+    );
+
+    std::string formatPrometheus(const ServerMetricsSnapshot& metrics, const std::string_view prefix = "nets");
+
+    // Replaces the file atomically, so that collectors reading it (such as node_exporter's
+    // textfile collector) never see it half written
+    bool writeMetricsFile(const std::filesystem::path& path, const std::string_view text);
+}
+
+// Implementation
+
+namespace nets
+{
+    inline double HistogramSnapshot::getBucketBound(const std::size_t bucket)
+    {
+        if(bucket + 1 >= buckets_count)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        return static_cast<double>(std::uint64_t{1} << bucket) / 1'000'000.0;
+    }
+
+    inline double HistogramSnapshot::getQuantile(const double quantile) const
+    {
+        if(count == 0)
+        {
+            return 0;
+        }
+
+        const auto rank {static_cast<std::uint64_t>(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count - 1))};
+
+        std::uint64_t cumulative_count {0};
+
+        for(std::size_t i {0}; i < buckets_count; ++i)
+        {
+            cumulative_count += buckets[i];
+
+            if(cumulative_count > rank)
+            {
+                return getBucketBound(i);
+            }
+        }
+
+        return getBucketBound(buckets_count - 1);
+    }
+
+    inline HistogramSnapshot& HistogramSnapshot::operator+=(const HistogramSnapshot& histogram)
+    {
+        for(std::size_t i {0}; i < buckets_count; ++i)
+        {
+            buckets[i] += histogram.buckets[i];
+        }
+
+        count += histogram.count;
+        sum   += histogram.sum;
+
+        return *this;
+    }
+
+    inline void DurationHistogram::record(const std::chrono::nanoseconds duration)
+    {
+        const auto microseconds {
+            static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0) / 1'000)
+        };
+
+        const auto bucket {
+            std::min<std::size_t>(std::bit_width(microseconds), HistogramSnapshot::buckets_count - 1)
+        };
+
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+        sum_ns.fetch_add(duration.count(), std::memory_order_relaxed);
+    }
+
+    inline HistogramSnapshot DurationHistogram::getSnapshot() const
+    {
+        HistogramSnapshot snapshot;
+
+        for(std::size_t i {0}; i < HistogramSnapshot::buckets_count; ++i)
+        {
+            snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+
+        // Counted from the buckets, so that they always add up
+        for(const auto bucket_count : snapshot.buckets)
+        {
+            snapshot.count += bucket_count;
+        }
+
+        snapshot.sum = std::chrono::nanoseconds{sum_ns.load(std::memory_order_relaxed)};
+
+        return snapshot;
+    }
+
+    template <std::size_t ids_count>
+    void MessageCounters<ids_count>::increment(const std::uint64_t message_id)
+    {
+        if(message_id < ids_count)
+        {
+            counters[message_id].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <std::size_t ids_count>
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> MessageCounters<ids_count>::getSnapshot() const
+    {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> snapshot;
+
+        for(std::size_t i {0}; i < ids_count; ++i)
+        {
+            if(const auto count {counters[i].load(std::memory_order_relaxed)}; count > 0)
+            {
+                snapshot.emplace_back(i, count);
+            }
+        }
+
+        return snapshot;
+    }
+
+    inline void MessageCounters<0>::increment(const std::uint64_t message_id)
+    {
+        const std::lock_guard lock {mutex};
+
+        if(const auto counter_iter {counters.find(message_id)}; counter_iter != counters.end())
+        {
+            ++counter_iter->second;
+        }
+        else if(counters.size() < max_tracked_ids)
+        {
+            counters.emplace(message_id, 1);
+        }
+        else 
+        {
+            ++other_count;
+        }
+    }
+
+    inline std::vector<std::pair<std::uint64_t, std::uint64_t>> MessageCounters<0>::getSnapshot() const
+    {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> snapshot;
+
+        {
+            const std::lock_guard lock {mutex};
+
+            snapshot.assign(counters.begin(), counters.end());
+
+            if(other_count > 0)
+            {
+                snapshot.emplace_back(other_message_id, other_count);
+            }
+        }
+
+        std::ranges::sort(snapshot);
+
+        return snapshot;
+    }
+
+    inline MetricsSnapshot& MetricsSnapshot::operator+=(const MetricsSnapshot& metrics)
+    {
+        bytes_received    += metrics.bytes_received;
+        bytes_sent        += metrics.bytes_sent;
+        messages_received += metrics.messages_received;
+        messages_sent     += metrics.messages_sent;
+        queued_bytes      += metrics.queued_bytes;
+        queued_messages   += metrics.queued_messages;
+
+        // Both sorted by id: merged in place
+        const auto merge {
+            [](auto& counts, const auto& added_counts)
+            {
+                const auto middle {counts.size()};
+
+                counts.insert(counts.end(), added_counts.begin(), added_counts.end());
+
+                std::ranges::inplace_merge(counts, counts.begin() + middle);
+
+                std::size_t merged_size {0};
+
+                for(std::size_t i {0}; i < counts.size(); ++i)
+                {
+                    if(merged_size > 0 && counts[merged_size - 1].first == counts[i].first)
+                    {
+                        counts[merged_size - 1].second += counts[i].second;
+                    }
+                    else
+                    {
+                        counts[merged_size++] = counts[i];
+                    }
+                }
+
+                counts.resize(merged_size);
+            }
+        };
+
+        merge(messages_received_by_id, metrics.messages_received_by_id);
+        merge(messages_sent_by_id,     metrics.messages_sent_by_id);
+
+        handler_durations     += metrics.handler_durations;
+        ping_round_trip_times += metrics.ping_round_trip_times;
+
+        return *this;
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordReceivedBytes(const std::size_t bytes_count)
+    {
+        bytes_received.fetch_add(bytes_count, std::memory_order_relaxed);
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordSentBytes(const std::size_t bytes_count)
+    {
+        bytes_sent.fetch_add(bytes_count, std::memory_order_relaxed);
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordReceivedMessage(const std::uint64_t message_id)
+    {
+        messages_received.increment(message_id);
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordSentMessage(const std::uint64_t message_id)
+    {
+        messages_sent.increment(message_id);
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordHandlerDuration(const std::chrono::nanoseconds duration)
+    {
+        handler_durations.record(duration);
+    }
+
+    template <std::size_t ids_count>
+    void MetricsRecorder<ids_count>::recordPingTime(const std::chrono::nanoseconds ping_time)
+    {
+        ping_round_trip_times.record(ping_time);
+    }
+
+    template <std::size_t ids_count>
+    MetricsSnapshot MetricsRecorder<ids_count>::getSnapshot() const
+    {
+        MetricsSnapshot snapshot;
+
+        snapshot.bytes_received = bytes_received.load(std::memory_order_relaxed);
+        snapshot.bytes_sent     = bytes_sent.load(std::memory_order_relaxed);
+
+        snapshot.messages_received_by_id = messages_received.getSnapshot();
+        snapshot.messages_sent_by_id     = messages_sent.getSnapshot();
+
+        for(const auto& [message_id, count] : snapshot.messages_received_by_id)
+        {
+            snapshot.messages_received += count;
+        }
+
+        for(const auto& [message_id, count] : snapshot.messages_sent_by_id)
+        {
+            snapshot.messages_sent += count;
+        }
+
+        snapshot.handler_durations     = handler_durations.getSnapshot();
+        snapshot.ping_round_trip_times = ping_round_trip_times.getSnapshot();
+
+        return snapshot;
+    }
+
+    inline std::string formatPrometheus(
+        std::span<const LabeledMetricsSnapshot> metrics,
+        const std::string_view                  prefix
+    )
+    {
+        std::string text;
+
+        const auto append_header {
+            [&](const std::string_view name, const std::string_view type, const std::string_view help)
+            {
+                text.append("# HELP ").append(prefix).append("_").append(name).append(" ").append(help).append("\n");
+                text.append("# TYPE ").append(prefix).append("_").append(name).append(" ").append(type).append("\n");
+            }
+        };
+
+        const auto append_sample {
+            [&](const std::string_view name, const std::string_view labels, const std::string_view extra_labels, const auto value)
+            {
+                text.append(prefix).append("_").append(name);
+
+                if(!labels.empty() || !extra_labels.empty())
+                {
+                    text.append("{").append(labels);
+
+                    if(!labels.empty() && !extra_labels.empty())
+                    {
+                        text.append(",");
+                    }
+
+                    text.append(extra_labels).append("}");
+                }
+
+                text.append(" ").append(std::to_string(value)).append("\n");
+            }
+        };
+
+        const auto append_value {
+            [&](const std::string_view name, const std::string_view type, const std::string_view help, const auto member)
+            {
+                append_header(name, type, help);
+
+                for(const auto& [labels, snapshot] : metrics)
+                {
+                    append_sample(name, labels, "", snapshot.*member);
+                }
+            }
+        };
+
+        const auto append_counts {
+            [&](const std::string_view name, const std::string_view help, const auto member)
+            {
+                append_header(name, "counter", help);
+
+                for(const auto& [labels, snapshot] : metrics)
+                {
+                    for(const auto& [message_id, count] : snapshot.*member)
+                    {
+                        const auto message_id_label {
+                            message_id == MessageCounters<0>::other_message_id ? std::string{"other"} : std::to_string(message_id)
+                        };
+
+                        append_sample(name, labels, "message_id=\"" + message_id_label + "\"", count);
+                    }
+                }
+            }
+        };
+
+        const auto append_histogram {
+            [&](const std::string_view name, const std::string_view help, const auto member)
+            {
+                append_header(name, "histogram", help);
+
+                for(const auto& [labels, snapshot] : metrics)
+                {
+                    const HistogramSnapshot& histogram {snapshot.*member};
+
+                    std::uint64_t cumulative_count {0};
+
+                    for(std::size_t i {0}; i < HistogramSnapshot::buckets_count; ++i)
+                    {
+                        cumulative_count += histogram.buckets[i];
+
+                        const auto bound {
+                            i + 1 < HistogramSnapshot::buckets_count ? std::to_string(HistogramSnapshot::getBucketBound(i)) : "+Inf"
+                        };
+
+                        append_sample(std::string{name} + "_bucket", labels, "le=\"" + bound + "\"", cumulative_count);
+                    }
+
+                    append_sample(std::string{name} + "_sum",   labels, "", std::chrono::duration<double>{histogram.sum}.count());
+                    append_sample(std::string{name} + "_count", labels, "", histogram.count);
+                }
+            }
+        };
+
+        append_value("received_bytes_total", "counter", "Bytes received, frame headers included.", &MetricsSnapshot::bytes_received);
+        append_value("sent_bytes_total",     "counter", "Bytes sent, frame headers included.",     &MetricsSnapshot::bytes_sent);
+
+        append_counts("received_messages_total", "Messages received, per message id.", &MetricsSnapshot::messages_received_by_id);
+        append_counts("sent_messages_total",     "Messages sent, per message id.",     &MetricsSnapshot::messages_sent_by_id);
+
+        append_value("queued_bytes",    "gauge", "Bytes waiting in outgoing queues.",    &MetricsSnapshot::queued_bytes);
+        append_value("queued_messages", "gauge", "Messages waiting in outgoing queues.", &MetricsSnapshot::queued_messages);
+
+        append_histogram("handler_duration_seconds", "Time spent running message handlers.", &MetricsSnapshot::handler_durations);
+        append_histogram("ping_rtt_seconds",         "Ping round trip times.",                &MetricsSnapshot::ping_round_trip_times);
+
+        return text;
+    }
+
+    inline std::string formatPrometheus(
+        const MetricsSnapshot& metrics,
+        const std::string_view labels,
+        const std::string_view prefix
+    )
+    {
+        const LabeledMetricsSnapshot labeled_metrics {std::string{labels}, metrics};
+
+        return formatPrometheus(std::span{&labeled_metrics, 1}, prefix);
+    }
+
+    inline std::string formatPrometheus(const ServerMetricsSnapshot& metrics, const std::string_view prefix)
+    {
+        std::string text;
+
+        const auto append_metric {
+            [&](const std::string_view name, const std::string_view type, const std::string_view help, const std::uint64_t value)
+            {
+                text.append("# HELP ").append(prefix).append("_").append(name).append(" ").append(help).append("\n");
+                text.append("# TYPE ").append(prefix).append("_").append(name).append(" ").append(type).append("\n");
+                text.append(prefix).append("_").append(name).append(" ").append(std::to_string(value)).append("\n");
+            }
+        };
+
+        append_metric("accepted_connections_total", "counter", "Connections accepted.",        metrics.connections_accepted);
+        append_metric("closed_connections_total",   "counter", "Connections closed.",          metrics.connections_closed);
+        append_metric("active_connections",         "gauge",   "Connections currently open.",  metrics.connections_active);
+        append_metric("accept_errors_total",        "counter", "Failed accept operations.",    metrics.accept_errors);
+
+        return text + formatPrometheus(metrics.connections, "", prefix);
+    }
+
+    inline bool writeMetricsFile(const std::filesystem::path& path, const std::string_view text)
+    {
+        auto temporary_path {path};
+
+        temporary_path += ".tmp";
+
+        {
+            std::ofstream file {temporary_path, std::ios::binary | std::ios::trunc};
+
+            if(!file.write(text.data(), static_cast<std::streamsize>(text.size())))
+            {
+                return false;
+            }
+        }
+
+        std::error_code error;
+
+        std::filesystem::rename(temporary_path, path, error);
+
+        return !error;
+    }
+}
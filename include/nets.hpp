@@ -3,6 +3,18 @@
 #include <boost/asio.hpp>
 
 #include "types.hpp"
+#include "handler_dispatcher.hpp"
+#include "ping_statistics.hpp"
+#include "buffer_pool.hpp"
+#include "message_view.hpp"
+#include "message_dispatch_table.hpp"
+#include "frame.hpp"
+#include "compression.hpp"
+#include "client_registry.hpp"
+#include "object_pool.hpp"
+#include "metrics.hpp"
+#include "timer_wheel.hpp"
 #include "tcp_server.hpp"
 #include "tcp_client.hpp"
+#include "tcp_client_pool.hpp"
 #include "tcp_remote.hpp"
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace nets
+{
+    // Recycles the memory of objects owned by std::shared_ptr, so that objects which are
+    // created and destroyed at a high rate (e.g. the remotes of a busy server) don't hit the
+    // allocator each time. Objects and their control blocks share one cached block.
+    // Must be owned by a std::shared_ptr
+    class ObjectPool : public std::enable_shared_from_this<ObjectPool>
+    {
+        public:
+            ObjectPool(const std::size_t max_cached_blocks = 1024);
+
+            ObjectPool(const ObjectPool&) = delete;
+
+            ObjectPool& operator=(const ObjectPool&) = delete;
+
+            ~ObjectPool();
+
+            // Like std::make_shared, reusing a cached block when available
+            template <typename Object, typename... Args>
+            std::shared_ptr<Object> make(Args&&... args);
+
+            std::size_t getCachedBlocksCount() const;
+
+        private:
+            template <typename Value>
+            class Allocator;
+
+            mutable std::mutex mutex;
+
+            std::vector<void*> cached_blocks;
+
+            std::size_t max_cached_blocks;
+
+            // Blocks of any other size aren't cached
+            std::size_t block_size {0};
+
+            void* allocate  (const std::size_t size);
+            void  deallocate(void* block, const std::size_t size);
+    };
+
+    // Keeps its pool alive until every block it allocated is released
+    template <typename Value>
+    class ObjectPool::Allocator
+    {
+        public:
+            using value_type = Value;
+
+            explicit Allocator(std::shared_ptr<ObjectPool> pool);
+
+            template <typename Other>
+            Allocator(const Allocator<Other>& allocator);
+
+            Value* allocate  (const std::size_t count);
+            void   deallocate(Value* values, const std::size_t count);
+
+            template <typename Other>
+            bool operator==(const Allocator<Other>& allocator) const;
+
+        private:
+            template <typename Other>
+            friend class Allocator;
+
+            std::shared_ptr<ObjectPool> pool;
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    inline ObjectPool::ObjectPool(const std::size_t max_cached_blocks)
+    :
+        max_cached_blocks{max_cached_blocks}
+    {
+        cached_blocks.reserve(max_cached_blocks);
+    }
+
+    inline ObjectPool::~ObjectPool()
+    {
+        for(auto block : cached_blocks)
+        {
+            ::operator delete(block);
+        }
+    }
+
+    template <typename Object, typename... Args>
+    std::shared_ptr<Object> ObjectPool::make(Args&&... args)
+    {
+        return std::allocate_shared<Object>(
+            Allocator<Object>{shared_from_this()},
+            std::forward<Args>(args)...
+        );
+    }
+
+    inline std::size_t ObjectPool::getCachedBlocksCount() const
+    {
+        const std::lock_guard lock {mutex};
+
+        return cached_blocks.size();
+    }
+
+    inline void* ObjectPool::allocate(const std::size_t size)
+    {
+        {
+            const std::lock_guard lock {mutex};
+
+            if(block_size == 0)
+            {
+                block_size = size;
+            }
+
+            if(size == block_size && !cached_blocks.empty())
+            {
+                const auto block {cached_blocks.back()};
+
+                cached_blocks.pop_back();
+
+                return block;
+            }
+        }
+
+        return ::operator new(size);
+    }
+
+    inline void ObjectPool::deallocate(void* block, const std::size_t size)
+    {
+        {
+            const std::lock_guard lock {mutex};
+
+            if(size == block_size && cached_blocks.size() < max_cached_blocks)
+            {
+                cached_blocks.push_back(block);
+
+                return;
+            }
+        }
+
+        ::operator delete(block);
+    }
+
+    template <typename Value>
+    ObjectPool::Allocator<Value>::Allocator(std::shared_ptr<ObjectPool> pool)
+    :
+        pool{std::move(pool)}
+    {}
+
+    template <typename Value>
+    template <typename Other>
+    ObjectPool::Allocator<Value>::Allocator(const Allocator<Other>& allocator)
+    :
+        pool{allocator.pool}
+    {}
+
+    template <typename Value>
+    Value* ObjectPool::Allocator<Value>::allocate(const std::size_t count)
+    {
+        static_assert(
+            alignof(Value) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+            "Over-aligned objects can't be pooled"
+        );
+
+        return static_cast<Value*>(pool->allocate(count * sizeof(Value)));
+    }
+
+    template <typename Value>
+    void ObjectPool::Allocator<Value>::deallocate(Value* values, const std::size_t count)
+    {
+        pool->deallocate(values, count * sizeof(Value));
+    }
+
+    template <typename Value>
+    template <typename Other>
+    bool ObjectPool::Allocator<Value>::operator==(const Allocator<Other>& allocator) const
+    {
+        return pool == allocator.pool;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace nets
+{
+    struct PingStatistics
+    {
+        using PingTime = std::chrono::duration<double>;
+
+        PingTime last    {0};
+        PingTime min     {0};
+        PingTime average {0};
+        PingTime p99     {0};
+
+        // Number of samples min, average and p99 were computed on
+        std::size_t samples_count {0};
+    };
+
+    // Keeps the round trip times of the last `window_size` pings of a remote
+    class PingStatisticsRecorder
+    {
+        public:
+            using PingTime = PingStatistics::PingTime;
+
+            static constexpr std::size_t window_size {128};
+
+            void record(const PingTime ping_time);
+
+            PingStatistics getStatistics() const;
+
+        private:
+            mutable std::mutex mutex;
+
+            std::array<PingTime, window_size> samples;
+
+            std::size_t next_sample   {0};
+            std::size_t samples_count {0};
+
+            PingTime last {0};
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    inline void PingStatisticsRecorder::record(const PingTime ping_time)
+    {
+        const std::lock_guard lock {mutex};
+
+        samples[next_sample] = ping_time;
+
+        next_sample   = (next_sample + 1) % window_size;
+        samples_count = std::min(samples_count + 1, window_size);
+
+        last = ping_time;
+    }
+
+    inline PingStatistics PingStatisticsRecorder::getStatistics() const
+    {
+        std::array<PingTime, window_size> window;
+
+        PingStatistics statistics;
+
+        {
+            const std::lock_guard lock {mutex};
+
+            std::copy_n(samples.begin(), samples_count, window.begin());
+
+            statistics.last          = last;
+            statistics.samples_count = samples_count;
+        }
+
+        if(statistics.samples_count == 0)
+        {
+            return statistics;
+        }
+
+        const auto window_end {window.begin() + statistics.samples_count};
+
+        PingTime sum {0};
+
+        for(auto sample {window.begin()}; sample != window_end; ++sample)
+        {
+            sum += *sample;
+        }
+
+        statistics.min     = *std::min_element(window.begin(), window_end);
+        statistics.average = sum / static_cast<double>(statistics.samples_count);
+
+        const auto p99 {window.begin() + (statistics.samples_count - 1) * 99 / 100};
+
+        std::nth_element(window.begin(), p99, window_end);
+
+        statistics.p99 = *p99;
+
+        return statistics;
+    }
+}
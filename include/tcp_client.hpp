@@ -2,6 +2,12 @@
 
 #include "types.hpp"
 #include "tcp_remote.hpp"
+#include "handler_dispatcher.hpp"
+#include "completion.hpp"
+#include "compression.hpp"
+
+#include <cmath>
+#include <random>
 
 namespace nets
 {
@@ -11,6 +17,7 @@ namespace nets
         public:
             using PingTime = Remote::PingTime;
 
+            // Runs its own io_context on a thread. Handlers run on a worker pool shared by such clients by default
             TcpClient(
                 const std::string_view address                   = "",
                 const std::string_view port                      = "",
@@ -18,32 +25,151 @@ namespace nets
                 const PingTime         ping_delay                = PingTime{6}
             );
 
+            // Runs on an io_context run by the caller, so that many clients can share a few threads.
+            // Handlers run inline on the connection's strand by default, so no pool is created per client.
+            // The io_context must have stopped running before the client is destroyed
+            TcpClient(
+                boost::asio::io_context& io_context,
+                const std::string_view   address             = "",
+                const std::string_view   port                = "",
+                const PingTime           ping_timeout_period = PingTime{4},
+                const PingTime           ping_delay          = PingTime{6}
+            );
+
             virtual ~TcpClient();
 
+            // Blocks until asyncConnect() completes, so the io_context must be run by another thread
             bool connect();
+
+            // Also stops reconnecting
             void disconnect();
 
-            virtual void onConnection(std::shared_ptr<Remote> server) = 0;
+            // Resolves and connects without blocking, completing with the error if any.
+            // Every resolved endpoint is tried at once, the first connection established being kept,
+            // and the whole attempt fails with boost::asio::error::timed_out after the connect timeout.
+            // Accepts any completion token, awaitable by default: `co_await client.asyncConnect();`
+            template <typename CompletionToken = boost::asio::use_awaitable_t<>>
+            auto asyncConnect(CompletionToken&& token = {});
+
+            // 0 (the default) for no timeout
+            void setConnectTimeout(const std::chrono::steady_clock::duration timeout);
+
+            // Once connected, reconnects whenever the connection is lost (until disconnect()), reusing the
+            // server remote along with its handlers. std::nullopt (the default) disables reconnection.
+            // Must be called before connecting
+            void setReconnectionPolicy(const std::optional<nets::ReconnectionPolicy> policy);
+
+            // Runs on its own thread once connected, unless onSession() is overridden
+            virtual void onConnection(std::shared_ptr<Remote> server) {};
+
+            // Coroutine run on the server remote's strand once connected, again after each reconnection.
+            // By default it runs onConnection() on a detached thread
+            virtual boost::asio::awaitable<void> onSession(std::shared_ptr<Remote> server);
+
+            // Called on the server remote's strand when the connection is lost and no more reconnection
+            // will be attempted, either because reconnection is disabled or because it ran out of attempts
+            virtual void onDisconnection(const boost::system::error_code error) {};
 
             void setServerAddress(const std::string_view address);
             void setServerPort   (const std::string_view port);
 
             std::string_view getServerAddress();
             std::string_view getServerPort   ();
+
+            // Selects how the server remote's message handlers are run, the previous dispatcher being kept
+            // until the client is destroyed, so it can be called from a handler
+            void setHandlerDispatch(
+                const nets::HandlerDispatch mode,
+                const std::size_t           workers_count = HandlerDispatcher::defaultWorkersCount()
+            );
+
+            nets::HandlerDispatch getHandlerDispatch() const;
+
+            // Compression of the messages exchanged with the server (see TcpRemote::setCompression()).
+            // Must be called before connecting
+            void setCompression(
+                std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+                const std::size_t                                    threshold = 1024,
+                const nets::DecompressionLimits                      limits    = {}
+            );
+
+            // Idle, write stall and handshake timeouts of the connection (see TcpRemote::setTimeouts()).
+            // Must be called before connecting
+            void setConnectionTimeouts(const nets::ConnectionTimeouts timeouts);
  
         private:
-            boost::asio::io_context client_io_context;
+            TcpClient(
+                std::unique_ptr<boost::asio::io_context> owned_io_context,
+                boost::asio::io_context*                 shared_io_context,
+                const std::string_view                   address,
+                const std::string_view                   port,
+                const PingTime                           ping_timeout_period,
+                const PingTime                           ping_delay
+            );
+
+            // Null when the io_context is the caller's
+            std::unique_ptr<boost::asio::io_context> owned_io_context;
+
+            boost::asio::io_context& client_io_context;
 
             std::string address;
             std::string port;            
 
+            std::shared_ptr<HandlerDispatcher>              handler_dispatcher;
+            std::vector<std::shared_ptr<HandlerDispatcher>> retired_handler_dispatchers;
+
+            using ConnectCompletion = std::move_only_function<void(boost::system::error_code)>;
+
+            // One connection attempt: its resolver, a socket per resolved endpoint and its timeout.
+            // Only accessed on the server remote's strand
+            struct ConnectAttempt
+            {
+                ConnectAttempt(const boost::asio::any_io_executor& executor);
+
+                boost::asio::ip::tcp::resolver resolver;
+                std::vector<nets::TcpSocket>   sockets;
+                boost::asio::steady_timer      timeout_timer;
+
+                std::size_t               pending_connects_count {0};
+                boost::system::error_code last_error;
+
+                // Null once the attempt is over
+                ConnectCompletion complete;
+            };
+
+            // Strand only
+            void startConnecting(ConnectCompletion complete);
+            void connectEndpoints(
+                const std::shared_ptr<ConnectAttempt>&              attempt,
+                const boost::asio::ip::tcp::resolver::results_type& endpoints
+            );
+            void finishConnecting(const std::shared_ptr<ConnectAttempt>& attempt, const boost::system::error_code error);
+
+            void handleConnection();
+            void handleConnectionLost(const boost::system::error_code error);
+            void scheduleReconnection(const boost::system::error_code error);
+
         public:
             std::shared_ptr<Remote> server;
 
         private:
             std::atomic_bool active {true};
 
-            boost::asio::executor_work_guard<decltype(client_io_context.get_executor())> client_io_context_work;
+            std::atomic<std::chrono::steady_clock::duration> connect_timeout {std::chrono::steady_clock::duration{0}};
+
+            std::optional<nets::ReconnectionPolicy> reconnection_policy;
+
+            // Strand only: reconnection state
+            bool                      is_reconnecting_enabled {false};
+            std::size_t               reconnection_attempts   {0};
+            boost::asio::steady_timer reconnection_timer;
+            std::minstd_rand          reconnection_random     {std::random_device{}()};
+
+            // Own io_context only: kept running by its thread until the client is destroyed
+            std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> client_io_context_work;
+
+            // Joined before client_io_context is destroyed
+            std::thread io_thread;
     };
 }
 
@@ -59,65 +185,389 @@ namespace nets
         const PingTime ping_delay 
     )
     :
-        client_io_context{},
+        TcpClient{std::make_unique<boost::asio::io_context>(), nullptr, address, port, ping_timer, ping_delay}
+    {}
+
+    template <typename MessageIdEnum, typename Remote>
+    TcpClient<MessageIdEnum, Remote>::TcpClient(
+        boost::asio::io_context& io_context,
+        const std::string_view   address,
+        const std::string_view   port,
+        const PingTime           ping_timer,
+        const PingTime           ping_delay
+    )
+    :
+        TcpClient{nullptr, &io_context, address, port, ping_timer, ping_delay}
+    {}
+
+    template <typename MessageIdEnum, typename Remote>
+    TcpClient<MessageIdEnum, Remote>::TcpClient(
+        std::unique_ptr<boost::asio::io_context> t_owned_io_context,
+        boost::asio::io_context*                 shared_io_context,
+        const std::string_view                   address,
+        const std::string_view                   port,
+        const PingTime                           ping_timer,
+        const PingTime                           ping_delay
+    )
+    :
+        owned_io_context{std::move(t_owned_io_context)},
+        client_io_context{owned_io_context ? *owned_io_context : *shared_io_context},
 
         address{address},
         port{port},
 
+        // Clients running their own io_context share a single worker pool, so that each of them costs one thread
+        handler_dispatcher{
+            owned_io_context ?
+                HandlerDispatcher::getShared()
+            :
+                std::make_shared<HandlerDispatcher>(HandlerDispatch::inline_strand)
+        },
+
         server{
             std::make_shared<Remote>(
                 client_io_context, ping_timer, ping_delay
             )
         },
 
-        client_io_context_work{client_io_context.get_executor()}
+        reconnection_timer{server->getSocket().get_executor()}
     {
-        std::thread {    
-            [&, this]
+        server->setHandlerExecutor(
+            handler_dispatcher->makeConnectionExecutor(server->getSocket().get_executor())
+        );
+
+        server->setOnConnectionLost(
+            [this](const boost::system::error_code error)
+            {
+                handleConnectionLost(error);
+            }
+        );
+
+        if(!owned_io_context)
+        {
+            return;
+        }
+
+        client_io_context_work.emplace(client_io_context.get_executor());
+
+        io_thread = std::thread {
+            [this]
             {
                 client_io_context.run();
             }
-        }.detach();
+        };
     }
 
     template <typename MessageIdEnum, typename Remote>
     TcpClient<MessageIdEnum, Remote>::~TcpClient()
     {
         active = false;
+
+        if(owned_io_context)
+        {
+            client_io_context.stop();
+
+            io_thread.join();
+        }
+
+        // The server remote may outlive the client
+        server->setOnConnectionLost(nullptr);
     }
 
     template <typename MessageIdEnum, typename Remote>
     bool TcpClient<MessageIdEnum, Remote>::connect()
     {
-        boost::system::error_code error;
+        try
+        {
+            asyncConnect(boost::asio::use_future).get();
+
+            return true;
+        }
+        catch(const boost::system::system_error&)
+        {
+            return false;
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    template <typename CompletionToken>
+    auto TcpClient<MessageIdEnum, Remote>::asyncConnect(CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [this](auto handler)
+            {
+                const auto executor {server->getSocket().get_executor()};
+
+                boost::asio::post(
+                    executor,
+                    [this, complete = makeCompletion<boost::system::error_code>(std::move(handler), executor)]() mutable
+                    {
+                        is_reconnecting_enabled = reconnection_policy.has_value();
+                        reconnection_attempts   = 0;
+
+                        reconnection_timer.cancel();
+
+                        startConnecting(std::move(complete));
+                    }
+                );
+            },
+            token
+        );
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    TcpClient<MessageIdEnum, Remote>::ConnectAttempt::ConnectAttempt(const boost::asio::any_io_executor& executor)
+    :
+        resolver{executor},
+        timeout_timer{executor}
+    {}
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::startConnecting(ConnectCompletion complete)
+    {
+        const auto attempt {std::make_shared<ConnectAttempt>(server->getSocket().get_executor())};
+
+        attempt->complete = std::move(complete);
+
+        if(const auto timeout {connect_timeout.load()}; timeout > std::chrono::steady_clock::duration{0})
+        {
+            attempt->timeout_timer.expires_after(timeout);
+
+            attempt->timeout_timer.async_wait(
+                [this, attempt](const boost::system::error_code error)
+                {
+                    if(!error && attempt->complete)
+                    {
+                        finishConnecting(attempt, boost::asio::error::timed_out);
+                    }
+                }
+            );
+        }
 
-        boost::asio::ip::tcp::resolver resolver {client_io_context};
+        attempt->resolver.async_resolve(
+            address,
+            port,
+            [this, attempt](
+                const boost::system::error_code                     error,
+                const boost::asio::ip::tcp::resolver::results_type endpoints
+            )
+            {
+                if(!attempt->complete)
+                {
+                    return;
+                }
+
+                if(error)
+                {
+                    finishConnecting(attempt, error);
+
+                    return;
+                }
 
-        boost::asio::connect(
-            server->getSocket(),
-            resolver.resolve(address, port),
-            error
+                connectEndpoints(attempt, endpoints);
+            }
         );
-        
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::connectEndpoints(
+        const std::shared_ptr<ConnectAttempt>&              attempt,
+        const boost::asio::ip::tcp::resolver::results_type& endpoints
+    )
+    {
+        if(endpoints.empty())
+        {
+            finishConnecting(attempt, boost::asio::error::host_not_found);
+
+            return;
+        }
+
+        // Sockets are all created first: connecting ones must not be moved by the vector growing
+        attempt->sockets.reserve(endpoints.size());
+
+        for(std::size_t i {0}; i < endpoints.size(); ++i)
+        {
+            attempt->sockets.emplace_back(server->getSocket().get_executor());
+        }
+
+        attempt->pending_connects_count = endpoints.size();
+
+        std::size_t socket_index {0};
+
+        for(const auto& entry : endpoints)
+        {
+            attempt->sockets[socket_index].async_connect(
+                entry.endpoint(),
+                [this, attempt, socket_index](const boost::system::error_code error)
+                {
+                    if(!attempt->complete)
+                    {
+                        return;
+                    }
+
+                    if(!error)
+                    {
+                        //std::println("DEBUG: Connected to endpoint {}", socket_index);
+
+                        server->getSocket() = std::move(attempt->sockets[socket_index]);
+
+                        finishConnecting(attempt, {});
+                    }
+                    else
+                    {
+                        attempt->last_error = error;
+
+                        if(--attempt->pending_connects_count == 0)
+                        {
+                            finishConnecting(attempt, attempt->last_error);
+                        }
+                    }
+                }
+            );
+
+            ++socket_index;
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::finishConnecting(
+        const std::shared_ptr<ConnectAttempt>& attempt,
+        const boost::system::error_code        error
+    )
+    {
+        auto complete {std::exchange(attempt->complete, nullptr)};
+
+        boost::system::error_code ignored_error;
+
+        attempt->timeout_timer.cancel();
+        attempt->resolver.cancel();
+
+        // Connections still being established to the other endpoints are abandoned
+        for(auto& socket : attempt->sockets)
+        {
+            socket.close(ignored_error);
+        }
+
         if(!error)
         {
-            server->start();
+            handleConnection();
+        }
+
+        complete(error);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::handleConnection()
+    {
+        reconnection_attempts = 0;
+
+        server->start();
+
+        boost::asio::co_spawn(
+            server->getSocket().get_executor(),
+            onSession(server),
+            boost::asio::detached
+        );
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::handleConnectionLost(const boost::system::error_code error)
+    {
+        //std::println("DEBUG: Connection lost: {}", error.message());
 
-            std::thread {
-                &TcpClient::onConnection, this, server
-            }.detach();
+        if(!is_reconnecting_enabled)
+        {
+            onDisconnection(error);
 
-            return true;   
+            return;
         }
-        else
+
+        // Pings may have expired on a socket still open
+        boost::system::error_code ignored_error;
+
+        server->getSocket().close(ignored_error);
+
+        scheduleReconnection(error);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::scheduleReconnection(const boost::system::error_code error)
+    {
+        const auto& policy {*reconnection_policy};
+
+        if(policy.max_attempts != 0 && reconnection_attempts >= policy.max_attempts)
         {
-            return false;
+            is_reconnecting_enabled = false;
+
+            onDisconnection(error);
+
+            return;
         }
+
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+
+        const auto backoff {
+            std::min(
+                Milliseconds{policy.initial_delay} * std::pow(policy.multiplier, static_cast<double>(reconnection_attempts)),
+                Milliseconds{policy.max_delay}
+            )
+        };
+
+        const auto delay {
+            backoff * (1 - std::uniform_real_distribution<double>{0, std::clamp(policy.jitter, 0.0, 1.0)}(reconnection_random))
+        };
+
+        ++reconnection_attempts;
+
+        reconnection_timer.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay));
+
+        reconnection_timer.async_wait(
+            [this](const boost::system::error_code error)
+            {
+                if(error || !is_reconnecting_enabled)
+                {
+                    return;
+                }
+
+                //std::println("DEBUG: Reconnecting, attempt {}", reconnection_attempts);
+
+                startConnecting(
+                    [this](const boost::system::error_code error)
+                    {
+                        if(error)
+                        {
+                            scheduleReconnection(error);
+                        }
+                    }
+                );
+            }
+        );
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    boost::asio::awaitable<void> TcpClient<MessageIdEnum, Remote>::onSession(std::shared_ptr<Remote> server)
+    {
+        std::thread {
+            &TcpClient::onConnection, this, server
+        }.detach();
+
+        co_return;
     }
 
     template <typename MessageIdEnum, typename Remote>
     void TcpClient<MessageIdEnum, Remote>::disconnect()
     {
+        // Before the socket is closed, so that its failure isn't taken for a lost connection
+        boost::asio::post(
+            server->getSocket().get_executor(),
+            [this]
+            {
+                is_reconnecting_enabled = false;
+
+                reconnection_timer.cancel();
+            }
+        );
+
         boost::system::error_code error;
 
         server->stop();
@@ -125,6 +575,18 @@ namespace nets
         server->getSocket().close(error);
     }
 
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::setConnectTimeout(const std::chrono::steady_clock::duration timeout)
+    {
+        connect_timeout = timeout;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::setReconnectionPolicy(const std::optional<nets::ReconnectionPolicy> policy)
+    {
+        reconnection_policy = policy;
+    }
+
     template <typename MessageIdEnum, typename Remote>
     void TcpClient<MessageIdEnum, Remote>::setServerAddress(const std::string_view t_address)
     {
@@ -137,6 +599,45 @@ namespace nets
         port = t_port;
     }
 
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::setHandlerDispatch(
+        const nets::HandlerDispatch mode,
+        const std::size_t           workers_count
+    )
+    {
+        auto dispatcher {std::make_shared<HandlerDispatcher>(mode, workers_count)};
+
+        server->setHandlerExecutor(
+            dispatcher->makeConnectionExecutor(server->getSocket().get_executor())
+        );
+
+        // Handlers already posted to the previous dispatcher's strand still run there: its pool is joined
+        // with the client, never from one of its own handlers
+        retired_handler_dispatchers.push_back(std::exchange(handler_dispatcher, std::move(dispatcher)));
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::setCompression(
+        std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+        const std::size_t                                    threshold,
+        const nets::DecompressionLimits                      limits
+    )
+    {
+        server->setCompression(std::move(codecs), threshold, limits);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClient<MessageIdEnum, Remote>::setConnectionTimeouts(const nets::ConnectionTimeouts timeouts)
+    {
+        server->setTimeouts(timeouts);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::HandlerDispatch TcpClient<MessageIdEnum, Remote>::getHandlerDispatch() const
+    {
+        return handler_dispatcher->getMode();
+    }
+
     template <typename MessageIdEnum, typename Remote>
     std::string_view TcpClient<MessageIdEnum, Remote>::getServerAddress()
     {
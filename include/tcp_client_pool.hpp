@@ -0,0 +1,514 @@
+#pragma once
+
+#include "types.hpp"
+#include "tcp_remote.hpp"
+#include "tcp_client.hpp"
+#include "compression.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <string>
+
+namespace nets
+{
+    struct ServerEndpoint
+    {
+        std::string address;
+        std::string port;
+    };
+
+    // Several connections to one or more servers, which sends are spread across, so that a process isn't
+    // limited by a single socket's write queue. Connections are spread evenly across the endpoints
+    // and share the pool's io threads. A connection is taken out of rotation while it's disconnected
+    // or while its last ping round trip time exceeds the configured maximum, and reconnects by itself
+    template <typename MessageIdEnum, typename Remote = nets::TcpRemote<MessageIdEnum>>
+    class TcpClientPool
+    {
+        public:
+            using PingTime = Remote::PingTime;
+
+            TcpClientPool(
+                const std::vector<ServerEndpoint>& endpoints,
+                const std::size_t                  connections_count,
+                const PingTime                     ping_timeout_period = PingTime{4},
+                const PingTime                     ping_delay          = PingTime{6},
+                const std::size_t                  io_threads_count    = 1
+            );
+
+            TcpClientPool(const TcpClientPool&) = delete;
+
+            TcpClientPool& operator=(const TcpClientPool&) = delete;
+
+            virtual ~TcpClientPool();
+
+            // Connects every connection at once, returning how many are connected
+            std::size_t connect();
+            void        disconnect();
+
+            // Round robin by default. With key_affinity, messages sent with the same key go through
+            // the same connection as long as it's healthy; those without a key are sent round robin
+            void                setLoadBalancing(const nets::LoadBalancing load_balancing);
+            nets::LoadBalancing getLoadBalancing() const;
+
+            // Connections whose last ping took longer are left out of rotation until a faster ping.
+            // Unlimited by default
+            void setMaxPingTime(const PingTime max_ping_time);
+
+            // The settings below apply to every connection and must be set before connecting.
+            // Reconnection is enabled by default, with a default nets::ReconnectionPolicy
+            void setReconnectionPolicy(const std::optional<nets::ReconnectionPolicy> policy);
+            void setConnectTimeout    (const std::chrono::steady_clock::duration     timeout);
+            void setConnectionTimeouts(const nets::ConnectionTimeouts                timeouts);
+
+            void setCompression(
+                std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+                const std::size_t                                    threshold = 1024,
+                const nets::DecompressionLimits                      limits    = {}
+            );
+
+            void setOnReceiving(
+                const MessageIdEnum                             message_id,
+                const typename Remote::MessageReceivedCallback& callback,
+                const bool                                      enabled = true
+            );
+
+            void setOnReceivingView(
+                const MessageIdEnum                                 message_id,
+                const typename Remote::MessageViewReceivedCallback& callback,
+                const bool                                          enabled = true
+            );
+
+            // Sent through the connection picked by the load balancing, applying its backpressure policy.
+            // Returns SendStatus::disconnected if no connection is healthy
+            nets::SendStatus send(mdsm::Collection message);
+            nets::SendStatus send(const std::uint64_t key, mdsm::Collection message);
+
+            // Never blocks, even with the block backpressure policy: a full queue returns SendStatus::queue_full
+            nets::SendStatus trySend(mdsm::Collection message);
+            nets::SendStatus trySend(const std::uint64_t key, mdsm::Collection message);
+
+            // The connection the next message would be sent through, nullptr if none is healthy
+            std::shared_ptr<Remote> pickConnection();
+            std::shared_ptr<Remote> pickConnection(const std::uint64_t key);
+
+            // Every connection, healthy or not, e.g. to set their queue limits
+            std::vector<std::shared_ptr<Remote>> getConnections() const;
+
+            std::size_t getConnectionsCount()        const;
+            std::size_t getHealthyConnectionsCount() const;
+
+            // Sum of the connections' metrics
+            nets::MetricsSnapshot getMetrics() const;
+
+        private:
+            // Doesn't run a thread per connection
+            class Client : public TcpClient<MessageIdEnum, Remote>
+            {
+                public:
+                    using TcpClient<MessageIdEnum, Remote>::TcpClient;
+
+                    virtual boost::asio::awaitable<void> onSession(std::shared_ptr<Remote> server) override
+                    {
+                        co_return;
+                    }
+            };
+
+            boost::asio::io_context io_context;
+
+            boost::asio::executor_work_guard<boost::asio::io_context::executor_type> io_context_work;
+
+            // Joined before the clients are destroyed
+            std::vector<std::thread> io_threads;
+
+            std::vector<std::unique_ptr<Client>> clients;
+
+            std::atomic<nets::LoadBalancing> load_balancing {nets::LoadBalancing::round_robin};
+            std::atomic<PingTime>            max_ping_time  {PingTime::max()};
+
+            std::atomic_size_t next_client_index {0};
+
+            bool isHealthy(Remote& remote) const;
+
+            std::shared_ptr<Remote> pickRoundRobin();
+            std::shared_ptr<Remote> pickLeastQueuedBytes();
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    template <typename MessageIdEnum, typename Remote>
+    TcpClientPool<MessageIdEnum, Remote>::TcpClientPool(
+        const std::vector<ServerEndpoint>& endpoints,
+        const std::size_t                  connections_count,
+        const PingTime                     ping_timeout_period,
+        const PingTime                     ping_delay,
+        const std::size_t                  io_threads_count
+    )
+    :
+        io_context_work{io_context.get_executor()}
+    {
+        if(!endpoints.empty())
+        {
+            clients.reserve(connections_count);
+
+            for(std::size_t i {0}; i < connections_count; ++i)
+            {
+                const auto& endpoint {endpoints[i % endpoints.size()]};
+
+                clients.push_back(
+                    std::make_unique<Client>(io_context, endpoint.address, endpoint.port, ping_timeout_period, ping_delay)
+                );
+
+                clients.back()->setReconnectionPolicy(nets::ReconnectionPolicy{});
+            }
+        }
+
+        for(std::size_t i {0}; i < std::max<std::size_t>(io_threads_count, 1); ++i)
+        {
+            io_threads.emplace_back(
+                [this]
+                {
+                    io_context.run();
+                }
+            );
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    TcpClientPool<MessageIdEnum, Remote>::~TcpClientPool()
+    {
+        io_context.stop();
+
+        for(auto& io_thread : io_threads)
+        {
+            io_thread.join();
+        }
+
+        clients.clear();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpClientPool<MessageIdEnum, Remote>::connect()
+    {
+        std::vector<std::future<void>> connections;
+
+        connections.reserve(clients.size());
+
+        for(auto& client : clients)
+        {
+            connections.push_back(client->asyncConnect(boost::asio::use_future));
+        }
+
+        std::size_t connected_count {0};
+
+        for(auto& connection : connections)
+        {
+            try
+            {
+                connection.get();
+
+                ++connected_count;
+            }
+            catch(const boost::system::system_error&)
+            {
+                //std::println("DEBUG: Pool connection failed");
+            }
+        }
+
+        return connected_count;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::disconnect()
+    {
+        for(auto& client : clients)
+        {
+            client->disconnect();
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setLoadBalancing(const nets::LoadBalancing t_load_balancing)
+    {
+        load_balancing = t_load_balancing;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::LoadBalancing TcpClientPool<MessageIdEnum, Remote>::getLoadBalancing() const
+    {
+        return load_balancing.load();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setMaxPingTime(const PingTime t_max_ping_time)
+    {
+        max_ping_time = t_max_ping_time;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setReconnectionPolicy(const std::optional<nets::ReconnectionPolicy> policy)
+    {
+        for(auto& client : clients)
+        {
+            client->setReconnectionPolicy(policy);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setConnectTimeout(const std::chrono::steady_clock::duration timeout)
+    {
+        for(auto& client : clients)
+        {
+            client->setConnectTimeout(timeout);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setConnectionTimeouts(const nets::ConnectionTimeouts timeouts)
+    {
+        for(auto& client : clients)
+        {
+            client->setConnectionTimeouts(timeouts);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setCompression(
+        std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+        const std::size_t                                    threshold,
+        const nets::DecompressionLimits                      limits
+    )
+    {
+        for(auto& client : clients)
+        {
+            client->setCompression(codecs, threshold, limits);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setOnReceiving(
+        const MessageIdEnum                             message_id,
+        const typename Remote::MessageReceivedCallback& callback,
+        const bool                                      enabled
+    )
+    {
+        for(auto& client : clients)
+        {
+            client->server->setOnReceiving(message_id, callback, enabled);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpClientPool<MessageIdEnum, Remote>::setOnReceivingView(
+        const MessageIdEnum                                 message_id,
+        const typename Remote::MessageViewReceivedCallback& callback,
+        const bool                                          enabled
+    )
+    {
+        for(auto& client : clients)
+        {
+            client->server->setOnReceivingView(message_id, callback, enabled);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::SendStatus TcpClientPool<MessageIdEnum, Remote>::send(mdsm::Collection message)
+    {
+        const auto connection {pickConnection()};
+
+        // Queued like TcpRemote::send(), reporting what the connection's backpressure policy did with it
+        return connection ? connection->trySend(std::move(message)) : SendStatus::disconnected;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::SendStatus TcpClientPool<MessageIdEnum, Remote>::send(const std::uint64_t key, mdsm::Collection message)
+    {
+        const auto connection {pickConnection(key)};
+
+        // Queued like TcpRemote::send(), reporting what the connection's backpressure policy did with it
+        return connection ? connection->trySend(std::move(message)) : SendStatus::disconnected;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::SendStatus TcpClientPool<MessageIdEnum, Remote>::trySend(mdsm::Collection message)
+    {
+        const auto connection {pickConnection()};
+
+        return connection ? connection->trySendNow(std::move(message)) : SendStatus::disconnected;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::SendStatus TcpClientPool<MessageIdEnum, Remote>::trySend(const std::uint64_t key, mdsm::Collection message)
+    {
+        const auto connection {pickConnection(key)};
+
+        return connection ? connection->trySendNow(std::move(message)) : SendStatus::disconnected;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::shared_ptr<Remote> TcpClientPool<MessageIdEnum, Remote>::pickConnection()
+    {
+        if(load_balancing.load(std::memory_order_relaxed) == LoadBalancing::least_queued_bytes)
+        {
+            return pickLeastQueuedBytes();
+        }
+
+        return pickRoundRobin();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::shared_ptr<Remote> TcpClientPool<MessageIdEnum, Remote>::pickConnection(const std::uint64_t key)
+    {
+        if(load_balancing.load(std::memory_order_relaxed) != LoadBalancing::key_affinity)
+        {
+            return pickConnection();
+        }
+
+        // Rendezvous hashing: the healthy connection with the highest score for the key wins,
+        // so a connection leaving the rotation only moves its own keys
+        const auto mix {
+            [](std::uint64_t value)
+            {
+                // splitmix64 finalizer
+                value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+                value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+
+                return value ^ (value >> 31);
+            }
+        };
+
+        std::shared_ptr<Remote> best_connection;
+        std::uint64_t           best_score {0};
+
+        for(std::size_t i {0}; i < clients.size(); ++i)
+        {
+            const auto& connection {clients[i]->server};
+
+            if(!isHealthy(*connection))
+            {
+                continue;
+            }
+
+            const auto score {mix(key ^ mix(i + 1))};
+
+            if(!best_connection || score > best_score)
+            {
+                best_connection = connection;
+                best_score      = score;
+            }
+        }
+
+        return best_connection;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::shared_ptr<Remote> TcpClientPool<MessageIdEnum, Remote>::pickRoundRobin()
+    {
+        const auto clients_count {clients.size()};
+
+        if(clients_count == 0)
+        {
+            return nullptr;
+        }
+
+        const auto first_index {next_client_index.fetch_add(1, std::memory_order_relaxed)};
+
+        // Skips unhealthy connections
+        for(std::size_t i {0}; i < clients_count; ++i)
+        {
+            const auto& connection {clients[(first_index + i) % clients_count]->server};
+
+            if(isHealthy(*connection))
+            {
+                return connection;
+            }
+        }
+
+        return nullptr;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::shared_ptr<Remote> TcpClientPool<MessageIdEnum, Remote>::pickLeastQueuedBytes()
+    {
+        std::shared_ptr<Remote> best_connection;
+        std::size_t             best_queued_bytes {0};
+
+        for(const auto& client : clients)
+        {
+            const auto& connection {client->server};
+
+            if(!isHealthy(*connection))
+            {
+                continue;
+            }
+
+            const auto queued_bytes {connection->getQueuedBytes()};
+
+            if(!best_connection || queued_bytes < best_queued_bytes)
+            {
+                best_connection   = connection;
+                best_queued_bytes = queued_bytes;
+            }
+        }
+
+        return best_connection;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    bool TcpClientPool<MessageIdEnum, Remote>::isHealthy(Remote& remote) const
+    {
+        return
+            remote.isConnected() &&
+            remote.getLastPingTime() <= max_ping_time.load(std::memory_order_relaxed);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::vector<std::shared_ptr<Remote>> TcpClientPool<MessageIdEnum, Remote>::getConnections() const
+    {
+        std::vector<std::shared_ptr<Remote>> connections;
+
+        connections.reserve(clients.size());
+
+        for(const auto& client : clients)
+        {
+            connections.push_back(client->server);
+        }
+
+        return connections;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpClientPool<MessageIdEnum, Remote>::getConnectionsCount() const
+    {
+        return clients.size();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpClientPool<MessageIdEnum, Remote>::getHealthyConnectionsCount() const
+    {
+        return std::ranges::count_if(
+            clients,
+            [this](const auto& client)
+            {
+                return isHealthy(*client->server);
+            }
+        );
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::MetricsSnapshot TcpClientPool<MessageIdEnum, Remote>::getMetrics() const
+    {
+        nets::MetricsSnapshot metrics;
+
+        for(const auto& client : clients)
+        {
+            metrics += client->server->getMetrics();
+        }
+
+        return metrics;
+    }
+}
@@ -9,10 +9,26 @@
 #include <memory>
 #include <deque>
 #include <optional>
+#include <array>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
 
 #include <print>
 
 #include "types.hpp"
+#include "ping_statistics.hpp"
+#include "buffer_pool.hpp"
+#include "message_view.hpp"
+#include "message_dispatch_table.hpp"
+#include "frame.hpp"
+#include "completion.hpp"
+#include "compression.hpp"
+#include "metrics.hpp"
+#include "timer_wheel.hpp"
 #include "collection.hpp"
 
 namespace nets
@@ -21,10 +37,12 @@ namespace nets
     class TcpRemote : public std::enable_shared_from_this<TcpRemote<MessageIdEnum>>
     {
         public:
-            using PingTime = std::chrono::duration<double>;
-            using MessageReceivedCallback = std::function<void(mdsm::Collection collection, TcpRemote& remote)>;
+            using PingTime   = std::chrono::duration<double>;
+            using PingResult = std::expected<PingTime, nets::PingError>;
+            using MessageReceivedCallback     = std::function<void(mdsm::Collection collection, TcpRemote& remote)>;
+            using MessageViewReceivedCallback = std::function<void(nets::MessageView message, TcpRemote& remote)>;
+            using RequestReceivedCallback     = std::function<void(nets::MessageView request, TcpRemote& remote, nets::RequestId request_id)>;
 
-            //TcpRemote(nets::TcpSocket& socket);
             TcpRemote(
                 boost::asio::io_context& io_context,
                 const PingTime           ping_timeout_period,
@@ -34,14 +52,84 @@ namespace nets
                 const std::function<void()>                                          on_pinging_timeout_callback = {}                
             );
 
+            // Wraps an already connected socket, which should be bound to a strand
+            // if the io_context is run by several threads
+            TcpRemote(
+                boost::asio::io_context& io_context,
+                nets::TcpSocket&&        socket,
+                const PingTime           ping_timeout_period,
+                const PingTime           ping_delay,
+                const std::function<void(mdsm::Collection)>&                         on_failed_sending_callback  = {},
+                const std::function<void(std::optional<boost::system::error_code>)>& on_failed_reading_callback  = {},
+                const std::function<void()>                                          on_pinging_timeout_callback = {}                
+            );
+
+            // Starts reading, pinging and writing on the connected socket. The remote can be started again
+            // once its socket is connected anew: messages still queued from the previous connection then fail
             void start();
             void stop();
 
             bool isConnected();
 
+            // Called on the connection's strand, once per connection, when it's found broken: reading failed
+            // or pings expired. Used by TcpClient to reconnect, user code having onFailedReading and onPingingTimeout
+            void setOnConnectionLost(std::function<void(boost::system::error_code)> callback);
+
             virtual ~TcpRemote();
 
-            void send(const mdsm::Collection& message);
+            // Queues the message, applying the backpressure policy if the outgoing queue is full.
+            // A moved message is never copied on its way to the socket
+            void send(const mdsm::Collection&  message);
+            void send(      mdsm::Collection&& message);
+
+            // Like send(), returning whether the message was queued.
+            // With BackpressurePolicy::block it waits for room in the queue, so it must not be
+            // called from handlers running on the connection's strand
+            nets::SendStatus trySend(const mdsm::Collection&  message);
+            nets::SendStatus trySend(      mdsm::Collection&& message);
+
+            // Like trySend(), but never waits: with BackpressurePolicy::block a full queue
+            // returns SendStatus::queue_full, so it can be called from any handler
+            nets::SendStatus trySendNow(const mdsm::Collection&  message);
+            nets::SendStatus trySendNow(      mdsm::Collection&& message);
+
+            // Queues a frame shared with other remotes (see TcpServer::broadcast())
+            void             send      (const nets::SharedFramePtr& frame);
+            nets::SendStatus trySend   (const nets::SharedFramePtr& frame);
+            nets::SendStatus trySendNow(const nets::SharedFramePtr& frame);
+
+            // Completes once the message is written to the socket, or with
+            // boost::asio::error::no_buffer_space if the outgoing queue is full (reject policy),
+            // boost::asio::error::not_connected if the remote is disconnected.
+            // Never blocks: with BackpressurePolicy::block the queue limits aren't enforced,
+            // as waiting for each write already paces the sender.
+            // Accepts any completion token, awaitable by default: `co_await remote->asyncSend(message);`
+            template <typename CompletionToken = boost::asio::use_awaitable_t<>>
+            auto asyncSend(mdsm::Collection message, CompletionToken&& token = {});
+
+            // Completes with the next message received with this id (with the id already retrieved).
+            // Once an id has been received this way, its messages aren't passed to its handler anymore,
+            // but kept until received. Receivers of a same id complete in order.
+            // Fails with the error which ended the connection
+            template <typename CompletionToken = boost::asio::use_awaitable_t<>>
+            auto receive(const MessageIdEnum message_id, CompletionToken&& token = {});
+
+            // Sends the message as a request and completes with its response: the message passed to reply()
+            // by the peer, id included. Fails with boost::asio::error::timed_out once `timeout` has elapsed,
+            // boost::asio::error::operation_not_supported if the peer has no request handler for the id,
+            // or the error which ended the connection. Any number of requests can be pending at once.
+            // Accepts any completion token, awaitable by default: `co_await remote->request(message, 1s);`
+            template <typename CompletionToken = boost::asio::use_awaitable_t<>>
+            auto request(
+                mdsm::Collection                          message,
+                const std::chrono::steady_clock::duration timeout,
+                CompletionToken&&                         token = {}
+            );
+
+            // Answers a request received by a request handler, from any thread, like send().
+            // Never blocks, even from the connection's strand: with BackpressurePolicy::block the
+            // response is queued over the limits, as the peer is waiting for it
+            void reply(const nets::RequestId request_id, mdsm::Collection response);
 
             /*
             virtual void onFailedSending (mdsm::Collection message) {};
@@ -57,20 +145,96 @@ namespace nets
             std::function<void(std::optional<boost::system::error_code>)> onFailedReading;
             std::function<void()>                                         onPingingTimeout;
 
+            // Called when the queued bytes reach the high watermark, then when they fall back to the low one
+            std::function<void()> onHighWatermark;
+            std::function<void()> onLowWatermark;
+
             void setOnReceiving(
                 const MessageIdEnum message_id,
                 const MessageReceivedCallback& callback,
                 const bool enabled = true
             );
 
+            // The callback receives a view of the pooled receive buffer instead of a copy of the message
+            void setOnReceivingView(
+                const MessageIdEnum message_id,
+                const MessageViewReceivedCallback& callback,
+                const bool enabled = true
+            );
+
+            // Handles the requests sent to this id with request(), to be answered with reply().
+            // Requests of an id without request handler fail right away on the sender's side
+            void setOnRequest(
+                const MessageIdEnum message_id,
+                const RequestReceivedCallback& callback,
+                const bool enabled = true
+            );
+
+            void setReceivingEnabled(const MessageIdEnum message_id, const bool enabled);
+
             void setPingingTimeoutPeriod(const PingTime period);
             void setPingingDelay        (const PingTime delay);
 
+            // Limits how many queued messages are coalesced into a single write
+            void setWriteBatchLimits(const std::size_t max_bytes, const std::size_t max_messages);
+
+            // Idle, write stall and handshake timeouts, all disabled by default. Must be called before start()
+            void setTimeouts(const nets::ConnectionTimeouts timeouts);
+
+            // Bounds the outgoing queue (unbounded by default); a single message is always accepted by an empty queue
+            void setOutgoingQueueLimits(const std::size_t max_bytes, const std::size_t max_messages);
+            void setBackpressurePolicy (const nets::BackpressurePolicy policy);
+            void setWatermarks         (const std::size_t high_bytes, const std::size_t low_bytes);
+
+            std::size_t getQueuedBytes()         const;
+            std::size_t getQueuedMessagesCount() const;
+
+            // Message handlers and failure callbacks are run on this executor
+            // (the connection's strand by default). Takes effect on the strand, before anything posted afterwards
+            void setHandlerExecutor(const boost::asio::any_io_executor& executor);
+
+            // Received messages are read into buffers taken from this pool
+            void setBufferPool(const std::shared_ptr<BufferPool>& pool);
+
+            // Size of the buffers incoming bytes are read into; messages larger than it get their own buffer
+            void setReceiveBufferSize(const std::size_t size);
+
+            // Frames larger than this (header included) close the connection before any buffer is taken for them,
+            // failing reading with boost::asio::error::message_size. 64 MiB by default
+            void setMaxReceivedFrameSize(const std::size_t size);
+
+            // Messages of at least `threshold` bytes are compressed with the first of these codecs
+            // which the peer has too. Codecs are announced to the peer on start(), and compression
+            // begins once the peer's announcement is received. Received compressed messages beyond
+            // `limits` are dropped. Must be called before start()
+            void setCompression(
+                std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+                const std::size_t                                    threshold = 1024,
+                const nets::DecompressionLimits                      limits    = {}
+            );
+
+            // Blocks until the ping completes: must not be called from the remote's handlers
             std::expected<PingTime, nets::PingError> ping(const PingTime period = PingTime{0});
 
+            // Non-blocking ping, completing with a PingResult.
+            // Accepts any completion token (a callback, boost::asio::use_future, boost::asio::use_awaitable...)
+            template <typename CompletionToken>
+            auto asyncPing(CompletionToken&& token);
+
+            // Round trip time of the last successful ping
+            PingTime getLastPingTime() const;
+
+            // Round trip times statistics of the last pings
+            PingStatistics getPingStatistics() const;
+
+            // Traffic, queue depth, handler durations and ping round trip times since the remote was built
+            nets::MetricsSnapshot getMetrics() const;
+
             std::string getAddress() const;
             nets::Port  getPort()    const;
 
+            nets::ConnectionId getId() const;
+
             nets::TcpSocket& getSocket();
 
             bool operator==(const TcpRemote& remote);
@@ -79,29 +243,270 @@ namespace nets
             boost::asio::io_context& io_context;
             nets::TcpSocket          socket;
 
+            // Shared by every connection of the io_context
+            nets::TimerWheel& timer_wheel;
+
+            inline static std::atomic<nets::ConnectionId> next_id {0};
+
+            const nets::ConnectionId id {next_id++};
+
             std::string address;
             nets::Port  port;
 
             PingTime ping_timeout_period;
             PingTime ping_delay;
 
-            std::unordered_map<MessageIdEnum, std::pair<MessageReceivedCallback, bool>> message_callbacks;
+            struct MessageHandler
+            {
+                MessageReceivedCallback     callback         {};
+                MessageViewReceivedCallback view_callback    {};
+                RequestReceivedCallback     request_callback {};
+            };
+
+            // Flat array when MessageIdEnum has a `count` enumerator (see nets::MessageIdsCount)
+            MessageDispatchTable<MessageIdEnum, MessageHandler> message_callbacks;
+
+            std::shared_ptr<BufferPool> buffer_pool;
+
+            // Reads fill this buffer with as many bytes as available, then every complete message
+            // in [receive_begin, receive_end) is handled before reading again
+            PooledBufferPtr    receive_buffer;
+            std::size_t        receive_begin {0};
+            std::size_t        receive_end   {0};
+            std::atomic_size_t receive_buffer_size {16 * 1024};
+
+            std::atomic_size_t max_received_frame_size {nets::default_max_received_frame_size};
+
+            // Returns the error to close the connection with if the stream is malformed
+            // or a frame is too large
+            boost::system::error_code parseReceivedMessages();
+
+            // `offset` and `size` delimit the message body, which follows its id
+            void handleReceivedMessage(
+                const MessageIdEnum    message_id,
+                const PooledBufferPtr& buffer,
+                const std::size_t      offset,
+                const std::size_t      size
+            );
+
+            // Whether messages with this id have a mailbox or an enabled handler
+            bool isReceivingEnabled(const MessageIdEnum message_id) const;
+
+            void failReading(const boost::system::error_code error);
+
+            std::function<void(boost::system::error_code)> on_connection_lost;
+
+            // Strand only. Completions of operations started on a previous connection are ignored
+            std::uint64_t connection_generation {0};
+            bool          is_connection_lost    {false};
+
+            void reportConnectionLost(const boost::system::error_code error);
+
+            // Drops what's left of the previous connection, if any
+            void resetConnectionState();
 
-            std::vector<std::byte> read_message_size;
-            mdsm::Collection       read_message_data;
+            std::vector<nets::FrameHeader>          write_headers;
+            std::vector<boost::asio::const_buffer> write_buffers;
+            std::size_t                            write_batch_count {0};
+            std::size_t                            write_batch_bytes {0};
+            bool                                   is_writing        {false};
 
-            std::atomic_bool ping_response_received {false};
+            // Bytes (headers included) and messages sent but not yet written
+            std::atomic_size_t queued_bytes    {0};
+            std::atomic_size_t queued_messages {0};
+
+            std::atomic_size_t max_queued_bytes    {std::numeric_limits<std::size_t>::max()};
+            std::atomic_size_t max_queued_messages {std::numeric_limits<std::size_t>::max()};
+
+            std::atomic<nets::BackpressurePolicy> backpressure_policy {nets::BackpressurePolicy::reject};
+
+            std::atomic_size_t high_watermark_bytes {std::numeric_limits<std::size_t>::max()};
+            std::atomic_size_t low_watermark_bytes  {0};
+            std::atomic_bool   is_above_high_watermark {false};
+
+            // Senders blocked by BackpressurePolicy::block wait for queue space or for the connection to be lost
+            std::mutex              queue_space_mutex;
+            std::condition_variable queue_space_available;
+            std::atomic_size_t      blocked_senders_count {0};
+
+            std::atomic_size_t max_write_batch_bytes    {256 * 1024};
+            std::atomic_size_t max_write_batch_messages {64};
 
             std::atomic_bool active       {true};
             std::atomic_bool is_connected {false};
 
-            std::deque<mdsm::Collection> outgoing_messages_queue;   
+            // Either owned by the remote or shared with other remotes
+            using SendCompletion    = std::move_only_function<void(boost::system::error_code)>;
+            using ReceiveCompletion = std::move_only_function<void(boost::system::error_code, mdsm::Collection)>;
+
+            struct OutgoingMessage
+            {
+                mdsm::Collection     message;
+                nets::SharedFramePtr shared_frame;
+
+                // Set by asyncSend()
+                SendCompletion complete;
+
+                nets::FrameFlags flags {0};
+
+                // The id goes into the frame header, and the body is what follows it in the message
+                std::uint64_t message_id  {0};
+                std::size_t   body_offset {0};
+
+                // Written after the header of correlated frames
+                std::uint64_t correlation {0};
+
+                const mdsm::Collection&    getMessage() const;
+                std::span<const std::byte> getBody()    const;
+            };
+
+            static OutgoingMessage makeOutgoingMessage(mdsm::Collection message, SendCompletion complete = nullptr);
+
+            std::deque<OutgoingMessage> outgoing_messages_queue;   
+
+            // Strand only
+            boost::asio::any_io_executor handler_executor;
+
+            template <typename Handler>
+            void dispatchHandler(Handler&& handler);
 
-            void asyncSend(const mdsm::Collection& message);
+            void writeQueuedMessages();
             void messagesSenderLoop();     
-            void sendMessageToQueue(const mdsm::Collection& message);
+            void sendMessageToQueue(OutgoingMessage&& message);
+
+            // Once the connection is broken: completes the queued messages with the error, reports those
+            // sent by the user to onFailedSending (requests failing instead) and releases their queue space
+            void failQueuedMessages(const boost::system::error_code error);
+
+            // What the block backpressure policy does with a message that doesn't fit in the queue:
+            // wait for room, queue it over the limits anyway, or return SendStatus::queue_full
+            enum class BlockingMode
+            {
+                wait, overfill, fail
+            };
+
+            nets::SendStatus enqueueMessage(OutgoingMessage&& message, const BlockingMode blocking_mode = BlockingMode::wait);
+
+            // Messages of an id handled by receive() and receivers waiting for them:
+            // at most one of the two queues isn't empty
+            struct Mailbox
+            {
+                std::deque<mdsm::Collection>  messages;
+                std::deque<ReceiveCompletion> receivers;
+            };
+
+            // Only accessed on the connection's strand
+            std::unordered_map<MessageIdEnum, Mailbox> mailboxes;
+
+            void failReceivers(const boost::system::error_code error);
+
+            std::vector<std::shared_ptr<const CompressionCodec>> compression_codecs;
+            std::atomic_size_t                                   compression_threshold {1024};
+            nets::DecompressionLimits                            decompression_limits;
+
+            // Negotiated with the peer: nullptr until its announcement is received
+            std::atomic<const CompressionCodec*> outgoing_codec {nullptr};
+
+            // Replaces the message with its compressed frame if worth it
+            void compressMessage(OutgoingMessage& message) const;
+
+            // The message as passed to send(), decompressed if it was compressed
+            std::optional<mdsm::Collection> getSentMessage(const OutgoingMessage& message) const;
+
+            void announceCodecs();
+
+            void handleFlaggedFrame(
+                const nets::DecodedFrameHeader& header,
+                const PooledBufferPtr&          buffer,
+                const std::size_t               offset
+            );
+
+            void handleControlFrame(const std::byte* data, const std::size_t size);
+
+            // Requests and responses, the body following the correlation
+            void handleCorrelatedMessage(
+                const MessageIdEnum    message_id,
+                const PooledBufferPtr& buffer,
+                const std::size_t      offset,
+                const std::size_t      size,
+                const std::uint64_t    correlation
+            );
+
+            static std::size_t getFrameSize(const OutgoingMessage& message);
+
+            bool reserveQueueSpace(const std::size_t frame_size, const bool enforce_limits = true);
+            void releaseQueueSpace(const std::size_t frame_size, const std::size_t messages_count);
+            bool hasQueueSpace    (const std::size_t frame_size) const;
+            void wakeBlockedSenders();
+            void dropOldestMessages();
+
+            struct PendingPing
+            {
+                std::chrono::steady_clock::time_point      sent_time;
+                nets::TimerWheel::TimerHandle              timeout_timer;
+                std::move_only_function<void(PingResult)>  complete;
+            };
+
+            // Pings state is only accessed on the connection's strand, so no thread
+            // nor spinning is needed per connection.
+            // Replies are matched to their ping through a sequence number
+            nets::TimerWheel::TimerHandle heartbeat_timer;
+
+            std::unordered_map<nets::PingSequence, PendingPing> pending_pings;
+            nets::PingSequence                                  next_ping_sequence {0};
+
+            std::atomic<PingTime>  last_ping_time {PingTime{0}};
+            PingStatisticsRecorder ping_statistics;
+
+            nets::MetricsRecorder<MessageIdsCount<MessageIdEnum>::value> metrics;
 
             void startPinging();     
+            void scheduleHeartbeat(const PingTime delay);
+            void sendHeartbeat();
+
+            void startPing(std::move_only_function<void(PingResult)> complete);
+            void handlePingResponse(const nets::PingSequence sequence);
+            void failPendingPings(const nets::PingError error);
+
+            struct PendingRequest
+            {
+                ReceiveCompletion             complete;
+                nets::TimerWheel::TimerHandle deadline_timer;
+            };
+
+            // Requests waiting for their response, only accessed on the connection's strand
+            std::unordered_map<nets::RequestId, PendingRequest> pending_requests;
+            nets::RequestId                                     next_request_id {0};
+
+            void startRequest(
+                mdsm::Collection                          message,
+                const std::chrono::steady_clock::duration timeout,
+                ReceiveCompletion                         complete
+            );
+
+            void expireRequest(const nets::RequestId request_id);
+            void failPendingRequest (const nets::RequestId request_id, const boost::system::error_code error);
+            void failPendingRequests(const boost::system::error_code error);
+
+            nets::ConnectionTimeouts timeouts;
+
+            // Strand only. Timers check the state of the connection when they fire rather than being armed
+            // again by every read and write: the idle one compares the time of the last read to its timeout
+            nets::TimerWheel::TimerHandle         idle_timer;
+            nets::TimerWheel::TimerHandle         write_stall_timer;
+            nets::TimerWheel::TimerHandle         handshake_timer;
+            std::chrono::steady_clock::time_point last_receive_time;
+            std::chrono::steady_clock::time_point write_start_time;
+            bool                                  has_received {false};
+
+            // Set when the connection is closed by a timeout, to be reported instead of the aborted read
+            boost::system::error_code closing_error;
+
+            void startTimeouts();
+            void cancelTimeouts();
+            void armIdleTimer         (const std::chrono::steady_clock::duration delay);
+            void armWriteStallTimer   (const std::chrono::steady_clock::duration delay);
+            void closeOnTimeout();
 
             void startMessagesListener();  
     };
@@ -120,58 +525,190 @@ namespace nets
         const std::function<void(std::optional<boost::system::error_code>)>& on_failed_reading_callback,
         const std::function<void()> on_pinging_timeout_callback        
     )
+    :
+        // Each connection owns a strand, so its handlers never run concurrently
+        // even when the io_context is driven by several threads
+        TcpRemote{
+            io_context,
+            nets::TcpSocket{boost::asio::make_strand(io_context)},
+            ping_timeout_period,
+            ping_delay,
+            on_failed_sending_callback,
+            on_failed_reading_callback,
+            on_pinging_timeout_callback
+        }
+    {}
+
+    template <typename MessageIdEnum>
+    TcpRemote<MessageIdEnum>::TcpRemote(
+        boost::asio::io_context& io_context,   
+        nets::TcpSocket&& t_socket,
+        const PingTime ping_timeout_period,
+        const PingTime ping_delay,
+        const std::function<void(mdsm::Collection)>& on_failed_sending_callback,
+        const std::function<void(std::optional<boost::system::error_code>)>& on_failed_reading_callback,
+        const std::function<void()> on_pinging_timeout_callback        
+    )
     :
         io_context               {io_context},
-        socket                   {io_context},
+        socket                   {std::move(t_socket)},
+        timer_wheel              {boost::asio::use_service<nets::TimerWheel>(io_context)},
         onFailedSending{on_failed_sending_callback},
         onFailedReading{on_failed_reading_callback},
         onPingingTimeout{on_pinging_timeout_callback},
         ping_timeout_period      {ping_timeout_period},
-        ping_delay               {ping_delay}
+        ping_delay               {ping_delay},
+        buffer_pool              {std::make_shared<BufferPool>()},
+        handler_executor         {socket.get_executor()}
     {
-        message_callbacks[MessageIdEnum::ping_request].second  = true;
-        message_callbacks[MessageIdEnum::ping_response].second = true;
-
-        read_message_size.resize(sizeof(mdsm::Collection::Size));
-
-        message_callbacks[MessageIdEnum::ping_response].first = [&, this](
-                const mdsm::Collection& collection,
-                TcpRemote<MessageIdEnum>& remote
-            )
+        setOnReceivingView(
+            MessageIdEnum::ping_response,
+            [&, this](nets::MessageView message, TcpRemote<MessageIdEnum>& remote)
             {
                 //std::println("DEBUG: Received ping response");
 
-                ping_response_received = true;            
-                //is_connected           = true;   
+                // Pings carry their sequence only: anything else is malformed and ignored
+                if(message.getSize() != sizeof(nets::PingSequence))
+                {
+                    return;
+                }
+
+                handlePingResponse(*message.read<nets::PingSequence>());
             }
-        ;
+        );
 
-        message_callbacks[MessageIdEnum::ping_request].first = [&, this](
-                const mdsm::Collection& collection,
-                TcpRemote<MessageIdEnum>& remote
-            )
+        setOnReceivingView(
+            MessageIdEnum::ping_request,
+            [&, this](nets::MessageView message, TcpRemote<MessageIdEnum>& remote)
             {
                 //std::println("DEBUG: Receiving ping request");
 
-                send(mdsm::Collection{} << MessageIdEnum::ping_response);               
+                if(message.getSize() != sizeof(nets::PingSequence))
+                {
+                    return;
+                }
+
+                // Collection::operator<< returns an lvalue: moved explicitly to avoid a copy
+                send(
+                    std::move(mdsm::Collection{} << MessageIdEnum::ping_response << *message.read<nets::PingSequence>())
+                );               
             }
-        ;
+        );
     }
 
     template <typename MessageIdEnum>
     void TcpRemote<MessageIdEnum>::start()
     {
+        resetConnectionState();
+
         is_connected = true;
 
+        announceCodecs();
+
         startPinging();
 
+        startTimeouts();
+
         startMessagesListener();
     }
 
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::resetConnectionState()
+    {
+        // Before a new connection is counted, as failed heartbeats report the connection lost
+        failPendingPings(PingError::failed_to_send);
+        failPendingRequests(boost::asio::error::not_connected);
+
+        ++connection_generation;
+
+        is_connection_lost = false;
+
+        cancelTimeouts();
+
+        has_received  = false;
+        closing_error = {};
+
+        receive_buffer.reset();
+
+        receive_begin = 0;
+        receive_end   = 0;
+
+        is_writing        = false;
+        write_batch_count = 0;
+
+        // Negotiated again with the new peer
+        outgoing_codec.store(nullptr, std::memory_order_release);
+
+        if(outgoing_messages_queue.empty())
+        {
+            return;
+        }
+
+        // Some of them may have been partially written to the previous peer
+        std::size_t dropped_bytes {0};
+
+        for(auto& outgoing_message : outgoing_messages_queue)
+        {
+            dropped_bytes += getFrameSize(outgoing_message);
+
+            if(outgoing_message.complete)
+            {
+                outgoing_message.complete(boost::asio::error::not_connected);
+            }
+        }
+
+        const auto dropped_messages {outgoing_messages_queue.size()};
+
+        outgoing_messages_queue.clear();
+
+        releaseQueueSpace(dropped_bytes, dropped_messages);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setOnConnectionLost(std::function<void(boost::system::error_code)> callback)
+    {
+        on_connection_lost = std::move(callback);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::reportConnectionLost(const boost::system::error_code error)
+    {
+        if(is_connection_lost)
+        {
+            return;
+        }
+
+        is_connection_lost = true;
+
+        wakeBlockedSenders();
+
+        if(on_connection_lost)
+        {
+            on_connection_lost(error);
+        }
+    }
+
     template <typename MessageIdEnum>
     void TcpRemote<MessageIdEnum>::stop()
     {
         is_connected = false;
+
+        wakeBlockedSenders();
+
+        boost::asio::post(
+            socket.get_executor(),
+            [weak_self = this->weak_from_this()]
+            {
+                if(const auto self {weak_self.lock()})
+                {
+                    self->timer_wheel.cancel(self->heartbeat_timer);
+                    self->cancelTimeouts();
+                    self->failPendingPings(PingError::failed_to_send);
+                    self->failReceivers(boost::asio::error::operation_aborted);
+                    self->failPendingRequests(boost::asio::error::operation_aborted);
+                }
+            }
+        );
     }
 
     template <typename MessageIdEnum>
@@ -185,313 +722,2033 @@ namespace nets
     {
         active = false;
         is_connected = false;
+
+        // Timers aren't cancelled here, as the remote may outlive its io_context and so the wheel:
+        // they're cancelled when the connection ends, and those left fire into an expired weak_ptr
     }
 
     template <typename MessageIdEnum>
     void TcpRemote<MessageIdEnum>::send(const mdsm::Collection &message)
     {
-        //std::println("DEBUG: send() start");
-
-        boost::asio::post(
-            socket.get_executor(),
-            std::bind(
-                &TcpRemote<MessageIdEnum>::sendMessageToQueue,
-                this,
-                message
-            )
-        );
-        
-        //std::println("DEBUG: send() end");
+        enqueueMessage(makeOutgoingMessage(message));
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::setPingingTimeoutPeriod(const PingTime t_ping_timeout_period)
+    void TcpRemote<MessageIdEnum>::send(mdsm::Collection&& message)
     {
-        ping_timeout_period = t_ping_timeout_period;
+        enqueueMessage(makeOutgoingMessage(std::move(message)));
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::setPingingDelay(const PingTime delay)
+    void TcpRemote<MessageIdEnum>::send(const nets::SharedFramePtr& frame)
     {
-        ping_delay = delay;
+        enqueueMessage(OutgoingMessage{{}, frame, nullptr, 0, frame->getMessageId()});
     }
 
     template <typename MessageIdEnum>
-    std::string TcpRemote<MessageIdEnum>::getAddress() const 
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySend(const mdsm::Collection &message)
     {
-        return socket.remote_endpoint().address().to_string();
+        return enqueueMessage(makeOutgoingMessage(message));
     }
 
     template <typename MessageIdEnum>
-    nets::Port TcpRemote<MessageIdEnum>::getPort() const 
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySend(mdsm::Collection&& message)
     {
-        return socket.remote_endpoint().port();
+        return enqueueMessage(makeOutgoingMessage(std::move(message)));
     }
 
     template <typename MessageIdEnum>
-    nets::TcpSocket& TcpRemote<MessageIdEnum>::getSocket()
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySend(const nets::SharedFramePtr& frame)
     {
-        return socket;
+        return enqueueMessage(OutgoingMessage{{}, frame, nullptr, 0, frame->getMessageId()});
     }
 
     template <typename MessageIdEnum>
-    bool TcpRemote<MessageIdEnum>::operator==(const TcpRemote& remote)
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySendNow(const mdsm::Collection &message)
     {
-        return getAddress() == remote.getAddress() && getPort() == remote.getPort();
+        return enqueueMessage(makeOutgoingMessage(message), BlockingMode::fail);
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::asyncSend(const mdsm::Collection& message)
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySendNow(mdsm::Collection&& message)
     {
-        //std::println("DEBUG: Sending message");
-
-        const auto message_size {message.getSize()};
-
-        //std::println("DEBUG: Header size: {}, Body size: {}", sizeof(message_size), message_size);
-
-        std::vector<std::byte> message_with_header (sizeof(message_size) + message_size);
-
-        // Transpose data to specific endianness
-        const auto prepared_message_size {message.prepareDataForInserting(message_size)};
+        return enqueueMessage(makeOutgoingMessage(std::move(message)), BlockingMode::fail);
+    }
 
-        std::memcpy(message_with_header.data(), prepared_message_size.data(), prepared_message_size.size());
-        std::memcpy(
-            message_with_header.data() + prepared_message_size.size(),
-            message.getData(),
-            message_size
-        );
+    template <typename MessageIdEnum>
+    nets::SendStatus TcpRemote<MessageIdEnum>::trySendNow(const nets::SharedFramePtr& frame)
+    {
+        return enqueueMessage(OutgoingMessage{{}, frame, nullptr, 0, frame->getMessageId()}, BlockingMode::fail);
+    }
 
-        boost::asio::async_write(
-            socket,
-            boost::asio::buffer(message_with_header.data(), message_with_header.size()),
-            [&, this](const boost::system::error_code& error, const std::size_t bytes_count)
-            {
-                if(!error)
-                {
-                    outgoing_messages_queue.pop_front();
-                    
-                    messagesSenderLoop();
-                }
-                else 
-                {
-                    if(onFailedSending)
-                    {
-                        std::thread {
-                            onFailedSending, message
-                        }.detach();
-                    }
-                }
-            }
-        );
+    template <typename MessageIdEnum>
+    const mdsm::Collection& TcpRemote<MessageIdEnum>::OutgoingMessage::getMessage() const
+    {
+        return shared_frame ? shared_frame->getMessage() : message;
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::messagesSenderLoop()
+    std::span<const std::byte> TcpRemote<MessageIdEnum>::OutgoingMessage::getBody() const
     {
-        if(outgoing_messages_queue.empty())
+        if(shared_frame)
         {
-            return;
+            return shared_frame->getBody();
         }
 
-        asyncSend(outgoing_messages_queue.front());
+        return {message.getData() + body_offset, message.getSize() - body_offset};
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::sendMessageToQueue(const mdsm::Collection &message)
+    typename TcpRemote<MessageIdEnum>::OutgoingMessage TcpRemote<MessageIdEnum>::makeOutgoingMessage(
+        mdsm::Collection message,
+        SendCompletion   complete
+    )
     {
-        //std::println("DEBUG: Sending message to queue");
+        OutgoingMessage outgoing_message {std::move(message), nullptr, std::move(complete)};
 
-        outgoing_messages_queue.push_back(message);
-
-        if(outgoing_messages_queue.size() == 1)
+        if(outgoing_message.message.getSize() >= sizeof(MessageIdEnum))
         {
-            messagesSenderLoop();
-        };
+            // The id is read in place: the message isn't copied to take it out
+            outgoing_message.message_id  = toWireMessageId(peekMessageId<MessageIdEnum>(outgoing_message.message.getData()));
+            outgoing_message.body_offset = sizeof(MessageIdEnum);
+        }
+
+        return outgoing_message;
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::startMessagesListener()
+    nets::SendStatus TcpRemote<MessageIdEnum>::enqueueMessage(OutgoingMessage&& message, const BlockingMode blocking_mode)
     {
-        if(!is_connected.load())
-        {
-            //std::println("DEBUG: Not continuing startMessageListener()");
-            return;
-        }
+        //std::println("DEBUG: send() start");
 
-        boost::asio::async_read(
-            socket,
-            boost::asio::buffer(read_message_size.data(), read_message_size.size()),
-            [&, this](const boost::system::error_code error, const std::size_t bytes_count)
+        if(!message.shared_frame && !(message.flags & frame_control_flag))
+        {
+            if(message.body_offset == 0)
             {
-                if(error)
+                // Malformed message, without id: dropped as its receiver would
+                if(message.complete)
                 {
-                    is_connected = false;
+                    message.complete(boost::asio::error::invalid_argument);
+                }
 
-                    if(onFailedReading)
-                    {
-                        std::thread {
-                            onFailedReading, error
-                        }.detach();
-                    }
+                return SendStatus::queued;
+            }
 
-                    return;
-                }
+            compressMessage(message);
+        }
 
-                //std::println("DEBUG: Inside first async read callback");
+        const auto frame_size {getFrameSize(message)};
 
-                //std::println("DEBUG: Reading message size");
+        const auto policy {backpressure_policy.load(std::memory_order_relaxed)};
 
-                const auto message_size {
-                    mdsm::Collection::prepareDataForExtracting<mdsm::Collection::Size>(
-                        read_message_size.data()
-                    )
-                };
+        if(policy == BackpressurePolicy::drop_oldest)
+        {
+            if(!reserveQueueSpace(frame_size))
+            {
+                // Queued anyway: older messages are dropped on the strand
+                reserveQueueSpace(frame_size, false);
+
+                boost::asio::post(
+                    socket.get_executor(),
+                    [self = this->shared_from_this()]
+                    {
+                        self->dropOldestMessages();
+                    }
+                );
+            }
+        }
+        else if(policy == BackpressurePolicy::block && blocking_mode == BlockingMode::overfill)
+        {
+            reserveQueueSpace(frame_size, false);
+        }
+        else if(policy == BackpressurePolicy::block && blocking_mode == BlockingMode::wait)
+        {
+            while(!reserveQueueSpace(frame_size))
+            {
+                std::unique_lock lock {queue_space_mutex};
+
+                // Counted before the queue is checked again, so that releasing space either is seen by the
+                // check or sees this sender waiting and notifies it
+                ++blocked_senders_count;
+
+                queue_space_available.wait(
+                    lock,
+                    [&]
+                    {
+                        return !is_connected || hasQueueSpace(frame_size);
+                    }
+                );
+
+                --blocked_senders_count;
+
+                if(!is_connected)
+                {
+                    return SendStatus::disconnected;
+                }
+            }
+        }
+        else if(!reserveQueueSpace(frame_size))
+        {
+            // The block policy also ends up here for senders that can't wait
+            if(policy == BackpressurePolicy::reject || policy == BackpressurePolicy::block)
+            {
+                if(message.complete)
+                {
+                    message.complete(boost::asio::error::no_buffer_space);
+                }
+
+                return SendStatus::queue_full;
+            }
+
+            //std::println("DEBUG: Disconnecting slow remote");
+
+            stop();
+
+            boost::asio::post(
+                socket.get_executor(),
+                [self = this->shared_from_this()]
+                {
+                    boost::system::error_code error;
+
+                    self->socket.close(error);
+                }
+            );
+
+            if(message.complete)
+            {
+                message.complete(boost::asio::error::not_connected);
+            }
+
+            return SendStatus::disconnected;
+        }
+
+        // Allocated through Asio's recycling handler allocator: the message is copied only if
+        // passed as an lvalue, and moved from here on
+        boost::asio::post(
+            socket.get_executor(),
+            [self = this->shared_from_this(), message = std::move(message)]() mutable
+            {
+                self->sendMessageToQueue(std::move(message));
+            }
+        );
+        
+        //std::println("DEBUG: send() end");
+
+        return SendStatus::queued;
+    }
+
+    template <typename MessageIdEnum>
+    std::size_t TcpRemote<MessageIdEnum>::getFrameSize(const OutgoingMessage& message)
+    {
+        if(message.shared_frame)
+        {
+            return message.shared_frame->getHeader().getSize() + message.shared_frame->getBody().size();
+        }
+
+        const std::size_t correlation_size {
+            (message.flags & frame_correlated_flag) ? getVarintSize(message.correlation) : 0
+        };
+
+        return nets::getFrameSize(message.message_id, correlation_size + message.message.getSize() - message.body_offset);
+    }
+
+    template <typename MessageIdEnum>
+    bool TcpRemote<MessageIdEnum>::reserveQueueSpace(const std::size_t frame_size, const bool enforce_limits)
+    {
+        const auto bytes    {queued_bytes.fetch_add(frame_size) + frame_size};
+        const auto messages {queued_messages.fetch_add(1) + 1};
+
+        if(
+            enforce_limits && messages > 1 && 
+            (bytes > max_queued_bytes.load(std::memory_order_relaxed) || messages > max_queued_messages.load(std::memory_order_relaxed))
+        )
+        {
+            queued_bytes    -= frame_size;
+            queued_messages -= 1;
+
+            return false;
+        }
+
+        if(bytes >= high_watermark_bytes.load(std::memory_order_relaxed) && !is_above_high_watermark.exchange(true))
+        {
+            if(onHighWatermark)
+            {
+                // Senders may be on any thread, while handlers are dispatched from the strand
+                boost::asio::post(
+                    socket.get_executor(),
+                    [self = this->shared_from_this()]
+                    {
+                        self->dispatchHandler(
+                            [self]
+                            {
+                                self->onHighWatermark();
+                            }
+                        );
+                    }
+                );
+            }
+        }
+
+        return true;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::releaseQueueSpace(const std::size_t frame_size, const std::size_t messages_count)
+    {
+        const auto bytes {queued_bytes.fetch_sub(frame_size) - frame_size};
+
+        queued_messages -= messages_count;
+
+        if(bytes <= low_watermark_bytes.load(std::memory_order_relaxed) && is_above_high_watermark.exchange(false))
+        {
+            if(onLowWatermark)
+            {
+                dispatchHandler(
+                    [self = this->shared_from_this()]
+                    {
+                        self->onLowWatermark();
+                    }
+                );
+            }
+        }
+
+        wakeBlockedSenders();
+    }
+
+    template <typename MessageIdEnum>
+    bool TcpRemote<MessageIdEnum>::hasQueueSpace(const std::size_t frame_size) const
+    {
+        const auto messages {queued_messages.load()};
+
+        return 
+            messages == 0 ||
+            (
+                queued_bytes.load() + frame_size <= max_queued_bytes.load(std::memory_order_relaxed) &&
+                messages + 1 <= max_queued_messages.load(std::memory_order_relaxed)
+            );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::wakeBlockedSenders()
+    {
+        if(blocked_senders_count.load() == 0)
+        {
+            return;
+        }
+
+        {
+            // A sender between its check and its wait holds the mutex: it's waiting once this gets it
+            const std::lock_guard lock {queue_space_mutex};
+        }
+
+        queue_space_available.notify_all();
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::dropOldestMessages()
+    {
+        // Messages being written can't be dropped
+        const auto first_droppable {is_writing ? write_batch_count : 0};
+
+        std::size_t dropped_bytes    {0};
+        std::size_t dropped_messages {0};
+
+        const auto max_bytes    {max_queued_bytes.load(std::memory_order_relaxed)};
+        const auto max_messages {max_queued_messages.load(std::memory_order_relaxed)};
+
+        auto message_iter {outgoing_messages_queue.begin() + first_droppable};
+
+        // Messages posted by trySend() but not in the queue yet are already counted
+        while(
+            message_iter != outgoing_messages_queue.end() &&
+            (queued_bytes - dropped_bytes > max_bytes || queued_messages - dropped_messages > max_messages)
+        )
+        {
+            dropped_bytes += getFrameSize(*message_iter);
+            ++dropped_messages;
+
+            ++message_iter;
+        }
+
+        //std::println("DEBUG: Dropped {} messages", dropped_messages);
+
+        for(auto dropped_iter {outgoing_messages_queue.begin() + first_droppable}; dropped_iter != message_iter; ++dropped_iter)
+        {
+            if(dropped_iter->complete)
+            {
+                dropped_iter->complete(boost::asio::error::operation_aborted);
+            }
+        }
+
+        outgoing_messages_queue.erase(outgoing_messages_queue.begin() + first_droppable, message_iter);
+
+        if(dropped_messages > 0)
+        {
+            releaseQueueSpace(dropped_bytes, dropped_messages);
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setTimeouts(const nets::ConnectionTimeouts t_timeouts)
+    {
+        timeouts = t_timeouts;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setOutgoingQueueLimits(const std::size_t max_bytes, const std::size_t max_messages)
+    {
+        max_queued_bytes    = max_bytes;
+        max_queued_messages = max_messages;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setBackpressurePolicy(const nets::BackpressurePolicy policy)
+    {
+        backpressure_policy = policy;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setWatermarks(const std::size_t high_bytes, const std::size_t low_bytes)
+    {
+        high_watermark_bytes = high_bytes;
+        low_watermark_bytes  = low_bytes;
+    }
+
+    template <typename MessageIdEnum>
+    std::size_t TcpRemote<MessageIdEnum>::getQueuedBytes() const
+    {
+        return queued_bytes.load(std::memory_order_relaxed);
+    }
+
+    template <typename MessageIdEnum>
+    std::size_t TcpRemote<MessageIdEnum>::getQueuedMessagesCount() const
+    {
+        return queued_messages.load(std::memory_order_relaxed);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setPingingTimeoutPeriod(const PingTime t_ping_timeout_period)
+    {
+        ping_timeout_period = t_ping_timeout_period;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setPingingDelay(const PingTime delay)
+    {
+        ping_delay = delay;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setWriteBatchLimits(const std::size_t max_bytes, const std::size_t max_messages)
+    {
+        max_write_batch_bytes    = max_bytes;
+        max_write_batch_messages = max_messages;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setHandlerExecutor(const boost::asio::any_io_executor& executor)
+    {
+        // Read by dispatchHandler() on the strand
+        boost::asio::post(
+            socket.get_executor(),
+            [self = this->shared_from_this(), executor]
+            {
+                self->handler_executor = executor;
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setBufferPool(const std::shared_ptr<BufferPool>& pool)
+    {
+        buffer_pool = pool;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setReceiveBufferSize(const std::size_t size)
+    {
+        receive_buffer_size = std::max<std::size_t>(size, max_frame_header_size);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setMaxReceivedFrameSize(const std::size_t size)
+    {
+        max_received_frame_size = size;
+    }
+
+    template <typename MessageIdEnum>
+    template <typename Handler>
+    void TcpRemote<MessageIdEnum>::dispatchHandler(Handler&& handler)
+    {
+        // Runs inline when the handler executor is the connection's strand,
+        // otherwise queues on the connection's strand of the workers pool
+        boost::asio::dispatch(handler_executor, std::forward<Handler>(handler));
+    }
+
+    template <typename MessageIdEnum>
+    std::string TcpRemote<MessageIdEnum>::getAddress() const 
+    {
+        return socket.remote_endpoint().address().to_string();
+    }
+
+    template <typename MessageIdEnum>
+    nets::Port TcpRemote<MessageIdEnum>::getPort() const 
+    {
+        return socket.remote_endpoint().port();
+    }
+
+    template <typename MessageIdEnum>
+    nets::ConnectionId TcpRemote<MessageIdEnum>::getId() const
+    {
+        return id;
+    }
+
+    template <typename MessageIdEnum>
+    nets::TcpSocket& TcpRemote<MessageIdEnum>::getSocket()
+    {
+        return socket;
+    }
+
+    template <typename MessageIdEnum>
+    bool TcpRemote<MessageIdEnum>::operator==(const TcpRemote& remote)
+    {
+        return getAddress() == remote.getAddress() && getPort() == remote.getPort();
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::writeQueuedMessages()
+    {
+        //std::println("DEBUG: Sending messages");
+
+        const auto max_bytes    {max_write_batch_bytes.load(std::memory_order_relaxed)};
+        const auto max_messages {std::max<std::size_t>(max_write_batch_messages.load(std::memory_order_relaxed), 1)};
+
+        write_buffers.clear();
+
+        if(write_headers.size() < max_messages)
+        {
+            write_headers.resize(max_messages);
+        }
+
+        // Gather as many queued messages as the limits allow (at least one) into a single write.
+        // Bodies aren't copied: they stay alive in the queue until the write completes
+        std::size_t batch_bytes {0};
+
+        write_batch_count = 0;
+
+        for(const auto& outgoing_message : outgoing_messages_queue)
+        {
+            const auto body       {outgoing_message.getBody()};
+            const auto frame_size {getFrameSize(outgoing_message)};
+
+            if(write_batch_count == max_messages || (write_batch_count > 0 && batch_bytes + frame_size > max_bytes))
+            {
+                break;
+            }
+
+            // Shared frames come with their header
+            const nets::FrameHeader* header {nullptr};
+
+            if(outgoing_message.shared_frame)
+            {
+                header = &outgoing_message.shared_frame->getHeader();
+            }
+            else 
+            {
+                encodeFrameHeader(
+                    outgoing_message.message_id,
+                    body.size(),
+                    outgoing_message.flags,
+                    outgoing_message.correlation,
+                    write_headers[write_batch_count]
+                );
+
+                header = &write_headers[write_batch_count];
+            }
+
+            write_buffers.push_back(boost::asio::buffer(header->getData(), header->getSize()));
+            write_buffers.push_back(boost::asio::buffer(body.data(), body.size()));
+
+            batch_bytes += frame_size;
+
+            ++write_batch_count;
+        }
+
+        //std::println("DEBUG: Batch messages: {}, Batch bytes: {}", write_batch_count, batch_bytes);
+
+        write_batch_bytes = batch_bytes;
+        is_writing        = true;
+
+        if(timeouts.write_stall > std::chrono::milliseconds{0})
+        {
+            write_start_time = std::chrono::steady_clock::now();
+
+            if(!write_stall_timer.isSet())
+            {
+                armWriteStallTimer(timeouts.write_stall);
+            }
+        }
+
+        boost::asio::async_write(
+            socket,
+            write_buffers,
+            [&, this, generation = connection_generation](const boost::system::error_code& error, const std::size_t bytes_count)
+            {
+                if(generation != connection_generation)
+                {
+                    // Written to a previous connection, whose queue was dropped
+                    return;
+                }
+
+                is_writing = false;
+
+                if(!error)
+                {
+                    metrics.recordSentBytes(bytes_count);
+
+                    for(std::size_t i {0}; i < write_batch_count; ++i)
+                    {
+                        auto& outgoing_message {outgoing_messages_queue[i]};
+
+                        if(!(outgoing_message.flags & frame_control_flag))
+                        {
+                            metrics.recordSentMessage(outgoing_message.message_id);
+                        }
+
+                        if(outgoing_message.complete)
+                        {
+                            outgoing_message.complete({});
+                        }
+                    }
+
+                    outgoing_messages_queue.erase(
+                        outgoing_messages_queue.begin(),
+                        outgoing_messages_queue.begin() + write_batch_count
+                    );
+
+                    releaseQueueSpace(write_batch_bytes, write_batch_count);
+                    
+                    messagesSenderLoop();
+                }
+                else 
+                {
+                    failPendingPings(PingError::failed_to_send);
+
+                    // The connection is broken: queued messages won't be written, nor those sent afterwards
+                    failQueuedMessages(error);
+
+                    is_connected = false;
+
+                    reportConnectionLost(error);
+
+                    if(!closing_error)
+                    {
+                        closing_error = error;
+                    }
+
+                    boost::system::error_code ignored_error;
+
+                    // Ends the pending read, which reports the write error
+                    socket.close(ignored_error);
+                }
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::messagesSenderLoop()
+    {
+        if(outgoing_messages_queue.empty())
+        {
+            return;
+        }
+
+        writeQueuedMessages();
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::sendMessageToQueue(OutgoingMessage&& message)
+    {
+        //std::println("DEBUG: Sending message to queue");
+
+        outgoing_messages_queue.push_back(std::move(message));
+
+        if(is_connection_lost)
+        {
+            failQueuedMessages(boost::asio::error::not_connected);
+
+            return;
+        }
+
+        if(!is_writing)
+        {
+            messagesSenderLoop();
+        };
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failQueuedMessages(const boost::system::error_code error)
+    {
+        std::size_t failed_bytes {0};
+
+        for(auto& outgoing_message : outgoing_messages_queue)
+        {
+            failed_bytes += getFrameSize(outgoing_message);
+
+            if(outgoing_message.complete)
+            {
+                outgoing_message.complete(error);
+            }
+
+            if(outgoing_message.flags & frame_control_flag)
+            {
+                // Internal: the user never sent it
+                continue;
+            }
+
+            if(outgoing_message.flags & frame_correlated_flag)
+            {
+                // Requests fail through their completion, responses having nobody waiting for them
+                if(getCorrelationKind(outgoing_message.correlation) == CorrelationKind::request)
+                {
+                    failPendingRequest(getCorrelationRequestId(outgoing_message.correlation), error);
+                }
+
+                continue;
+            }
+
+            if(
+                outgoing_message.message_id == toWireMessageId(MessageIdEnum::ping_request) ||
+                outgoing_message.message_id == toWireMessageId(MessageIdEnum::ping_response)
+            )
+            {
+                continue;
+            }
+
+            if(onFailedSending)
+            {
+                auto failed_message {getSentMessage(outgoing_message)};
+
+                if(!failed_message)
+                {
+                    continue;
+                }
+
+                dispatchHandler(
+                    [self = this->shared_from_this(), message = std::move(*failed_message)]
+                    {
+                        self->onFailedSending(message);
+                    }
+                );
+            }
+        }
+
+        const auto failed_messages {outgoing_messages_queue.size()};
+
+        outgoing_messages_queue.clear();
+
+        if(failed_messages > 0)
+        {
+            releaseQueueSpace(failed_bytes, failed_messages);
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::startMessagesListener()
+    {
+        if(!is_connected.load())
+        {
+            //std::println("DEBUG: Not continuing startMessageListener()");
+            return;
+        }
+
+        if(!receive_buffer)
+        {
+            receive_buffer = buffer_pool->acquire(receive_buffer_size.load(std::memory_order_relaxed));
+        }
+
+        socket.async_read_some(
+            boost::asio::buffer(
+                receive_buffer->getData() + receive_end,
+                receive_buffer->getSize() - receive_end
+            ),
+            [&, this, generation = connection_generation](const boost::system::error_code error, const std::size_t bytes_count)
+            {
+                if(generation != connection_generation)
+                {
+                    return;
+                }
+
+                if(error)
+                {
+                    // A connection closed by a timeout reports it rather than the aborted read
+                    failReading(closing_error ? closing_error : error);
+
+                    return;
+                }
+
+                //std::println("DEBUG: Read {} bytes", bytes_count);
+
+                if(timeouts.idle > std::chrono::milliseconds{0})
+                {
+                    last_receive_time = std::chrono::steady_clock::now();
+                }
+
+                if(!has_received)
+                {
+                    has_received = true;
+
+                    timer_wheel.cancel(handshake_timer);
+                }
+
+                receive_end += bytes_count;
+
+                metrics.recordReceivedBytes(bytes_count);
+
+                if(const auto parse_error {parseReceivedMessages()})
+                {
+                    //std::println("DEBUG: Malformed frame, closing connection");
+
+                    boost::system::error_code close_error;
+
+                    socket.close(close_error);
+
+                    failReading(parse_error);
+
+                    return;
+                }
+
+                startMessagesListener();
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failReading(const boost::system::error_code error)
+    {
+        is_connected = false;
+
+        timer_wheel.cancel(heartbeat_timer);
+
+        cancelTimeouts();
+
+        failReceivers(error);
+        failPendingRequests(error);
+
+        reportConnectionLost(error);
+
+        if(onFailedReading)
+        {
+            dispatchHandler(
+                [self = this->shared_from_this(), error]
+                {
+                    self->onFailedReading(error);
+                }
+            );
+        }
+    }
+
+    template <typename MessageIdEnum>
+    boost::system::error_code TcpRemote<MessageIdEnum>::parseReceivedMessages()
+    {
+        using WireMessageId = std::make_unsigned_t<std::underlying_type_t<MessageIdEnum>>;
+
+        // Handles every complete message held by the receive buffer: they share it, so no copy is made
+        std::size_t required_size {1};
+
+        while(receive_end > receive_begin)
+        {
+            nets::DecodedFrameHeader header;
+
+            const auto header_status {
+                decodeFrameHeader(
+                    {receive_buffer->getData() + receive_begin, receive_end - receive_begin},
+                    header
+                )
+            };
+
+            if(header_status == FrameHeaderStatus::malformed)
+            {
+                return boost::asio::error::invalid_argument;
+            }
+            else if(header_status == FrameHeaderStatus::incomplete)
+            {
+                required_size = max_frame_header_size;
+
+                break;
+            }
+
+            required_size = header.size + header.body_size;
+
+            // The size is the peer's claim: checked before a buffer is taken for it
+            if(required_size > max_received_frame_size.load(std::memory_order_relaxed))
+            {
+                return boost::asio::error::message_size;
+            }
+
+            if(receive_end - receive_begin < required_size)
+            {
+                break;
+            }
+
+            const auto body_offset {receive_begin + header.size};
+
+            const bool is_known_id {header.message_id <= std::numeric_limits<WireMessageId>::max()};
+
+            if(is_known_id && !(header.flags & frame_control_flag))
+            {
+                metrics.recordReceivedMessage(header.message_id);
+            }
+
+            if(!is_known_id)
+            {
+                // Unknown message id: dropped without touching the body, nor counting it
+            }
+            else if(header.flags == 0)
+            {
+                handleReceivedMessage(
+                    fromWireMessageId<MessageIdEnum>(header.message_id), receive_buffer, body_offset, header.body_size
+                );
+            }
+            else 
+            {
+                handleFlaggedFrame(header, receive_buffer, body_offset);
+            }
+
+            receive_begin += required_size;
+            required_size  = 1;
+        }
+
+        const auto carried_size {receive_end - receive_begin};
+
+        const bool is_buffer_shared {receive_buffer->getReferencesCount() > 1};
+
+        if(carried_size == 0 && !is_buffer_shared)
+        {
+            receive_begin = receive_end = 0;
+        }
+        else if(is_buffer_shared || receive_begin + required_size > receive_buffer->getSize())
+        {
+            // The buffer is either still referenced by handlers or too small for the partial message:
+            // the partial message is carried over to a new one
+            auto new_buffer {
+                buffer_pool->acquire(std::max(receive_buffer_size.load(std::memory_order_relaxed), required_size))
+            };
+
+            if(carried_size > 0)
+            {
+                std::memcpy(new_buffer->getData(), receive_buffer->getData() + receive_begin, carried_size);
+            }
+
+            receive_buffer = std::move(new_buffer);
+
+            receive_begin = 0;
+            receive_end   = carried_size;
+        }
+
+        return {};
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::handleReceivedMessage(
+        const MessageIdEnum    message_id,
+        const PooledBufferPtr& buffer,
+        const std::size_t      offset,
+        const std::size_t      size
+    )
+    {
+        if(
+            !mailboxes.empty() &&
+            message_id != MessageIdEnum::ping_request && message_id != MessageIdEnum::ping_response
+        )
+        {
+            const auto mailbox_iter {mailboxes.find(message_id)};
+
+            if(mailbox_iter != mailboxes.end())
+            {
+                auto& mailbox {mailbox_iter->second};
+
+                auto collection {nets::MessageView{buffer, offset, size}.toCollection()};
+
+                if(mailbox.receivers.empty())
+                {
+                    mailbox.messages.push_back(std::move(collection));
+                }
+                else 
+                {
+                    auto complete {std::move(mailbox.receivers.front())};
+
+                    mailbox.receivers.pop_front();
+
+                    complete({}, std::move(collection));
+                }
+
+                return;
+            }
+        }
+
+        const auto handler {message_callbacks.find(message_id)};
+
+        if(!handler)
+        {
+            // No callback found for received message id, or callback disabled
+            return;
+        }
+
+        //std::println("DEBUG: Callback is being called - Message ID = {}", static_cast<std::size_t>(message_id));
+
+        if((message_id == MessageIdEnum::ping_request || message_id == MessageIdEnum::ping_response) && handler->view_callback)
+        {
+            // Pinging is handled internally and must not wait behind user handlers
+            handler->view_callback(
+                nets::MessageView{buffer, offset, size},
+                *this
+            );
+        }
+        else if(handler->view_callback)
+        {
+            // The handler shares the receive buffer: no copy
+            dispatchHandler(
+                [
+                    handler,
+                    view     = nets::MessageView{buffer, offset, size},
+                    self     = this->shared_from_this()
+                ]
+                () mutable
+                {
+                    const auto start_time {std::chrono::steady_clock::now()};
+
+                    handler->view_callback(std::move(view), *self);
+
+                    self->metrics.recordHandlerDuration(std::chrono::steady_clock::now() - start_time);
+                }
+            );
+        }
+        else if(handler->callback)
+        {
+            // Handlers taking a Collection get their own copy of the body, the id being in the header
+            auto collection {nets::MessageView{buffer, offset, size}.toCollection()};
+
+            dispatchHandler(
+                [
+                    handler,
+                    message = std::move(collection),
+                    self    = this->shared_from_this()
+                ]
+                () mutable
+                {
+                    const auto start_time {std::chrono::steady_clock::now()};
+
+                    handler->callback(std::move(message), *self);
+
+                    self->metrics.recordHandlerDuration(std::chrono::steady_clock::now() - start_time);
+                }
+            );
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::handleFlaggedFrame(
+        const nets::DecodedFrameHeader& header,
+        const PooledBufferPtr&          buffer,
+        const std::size_t               offset
+    )
+    {
+        auto       data       {buffer->getData() + offset};
+        auto       size       {header.body_size};
+        const auto message_id {fromWireMessageId<MessageIdEnum>(header.message_id)};
+
+        std::optional<std::uint64_t> correlation;
+
+        if(header.flags & frame_correlated_flag)
+        {
+            std::uint64_t decoded_correlation {0};
+
+            const auto correlation_size {decodeVarint({data, size}, decoded_correlation)};
+
+            if(!correlation_size || *correlation_size == 0)
+            {
+                // Malformed message
+                return;
+            }
+
+            correlation = decoded_correlation;
+
+            data += *correlation_size;
+            size -= *correlation_size;
+        }
+
+        const auto handleMessage {
+            [&, this](const PooledBufferPtr& message_buffer, const std::size_t message_offset, const std::size_t message_size)
+            {
+                if(correlation)
+                {
+                    handleCorrelatedMessage(message_id, message_buffer, message_offset, message_size, *correlation);
+                }
+                else 
+                {
+                    handleReceivedMessage(message_id, message_buffer, message_offset, message_size);
+                }
+            }
+        };
+
+        if(header.flags & frame_control_flag)
+        {
+            handleControlFrame(data, size);
+        }
+        else if(header.flags & frame_chunked_flag)
+        {
+            // Not supported yet
+            return;
+        }
+        else if(header.flags & frame_compressed_flag)
+        {
+            if(!correlation && !isReceivingEnabled(message_id))
+            {
+                // Nobody would get the message: it isn't decompressed
+                return;
+            }
+
+            constexpr auto prefix_size {sizeof(CompressionCodecId) + sizeof(mdsm::Collection::Size)};
+
+            if(size < prefix_size)
+            {
+                // Malformed message
+                return;
+            }
+
+            const auto codec_iter {
+                std::ranges::find_if(
+                    compression_codecs,
+                    [codec_id = static_cast<CompressionCodecId>(data[0])](const auto& codec)
+                    {
+                        return codec->getId() == codec_id;
+                    }
+                )
+            };
+
+            const std::size_t uncompressed_size {
+                mdsm::Collection::prepareDataForExtracting<mdsm::Collection::Size>(data + sizeof(CompressionCodecId))
+            };
+
+            if(codec_iter == compression_codecs.end() || uncompressed_size > max_frame_size)
+            {
+                // Unknown codec or malformed message
+                return;
+            }
+
+            // The size is the peer's claim: checked before being allocated
+            if(
+                uncompressed_size > decompression_limits.max_size ||
+                uncompressed_size / std::max<std::size_t>(size - prefix_size, 1) > decompression_limits.max_ratio
+            )
+            {
+                return;
+            }
+
+            // Decompressed into its own pooled buffer, which handlers can share like the receive buffer
+            auto uncompressed_buffer {buffer_pool->acquire(uncompressed_size)};
+
+            const auto is_decompressed {
+                (*codec_iter)->decompress(
+                    {data + prefix_size, size - prefix_size},
+                    {uncompressed_buffer->getData(), uncompressed_size}
+                )
+            };
+
+            if(is_decompressed)
+            {
+                handleMessage(uncompressed_buffer, 0, uncompressed_size);
+            }
+        }
+        else 
+        {
+            // Flags which don't change how the body is read
+            handleMessage(buffer, data - buffer->getData(), size);
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::handleCorrelatedMessage(
+        const MessageIdEnum    message_id,
+        const PooledBufferPtr& buffer,
+        const std::size_t      offset,
+        const std::size_t      size,
+        const std::uint64_t    correlation
+    )
+    {
+        const auto request_id {getCorrelationRequestId(correlation)};
+        const auto kind       {getCorrelationKind(correlation)};
+
+        if(kind == CorrelationKind::request)
+        {
+            const auto handler {message_callbacks.find(message_id)};
+
+            if(!handler || !handler->request_callback)
+            {
+                // Answered right away, rather than letting the request expire
+                auto unhandled {makeOutgoingMessage(std::move(mdsm::Collection{} << message_id))};
+
+                unhandled.flags       = frame_correlated_flag;
+                unhandled.correlation = encodeCorrelation(request_id, CorrelationKind::unhandled);
+
+                enqueueMessage(std::move(unhandled), BlockingMode::overfill);
+
+                return;
+            }
+
+            dispatchHandler(
+                [
+                    handler,
+                    request_id,
+                    view = nets::MessageView{buffer, offset, size},
+                    self = this->shared_from_this()
+                ]
+                () mutable
+                {
+                    const auto start_time {std::chrono::steady_clock::now()};
+
+                    handler->request_callback(std::move(view), *self, request_id);
+
+                    self->metrics.recordHandlerDuration(std::chrono::steady_clock::now() - start_time);
+                }
+            );
+
+            return;
+        }
+
+        const auto pending_request_iter {pending_requests.find(request_id)};
+
+        if(pending_request_iter == pending_requests.end())
+        {
+            // Late response to an expired request
+            return;
+        }
+
+        auto complete {std::move(pending_request_iter->second.complete)};
+
+        timer_wheel.cancel(pending_request_iter->second.deadline_timer);
+
+        pending_requests.erase(pending_request_iter);
+
+        if(kind == CorrelationKind::unhandled)
+        {
+            complete(boost::asio::error::operation_not_supported, {});
+
+            return;
+        }
+
+        // The response is given back whole, as its id tells what kind of answer it is
+        const auto prepared_message_id {mdsm::Collection::prepareDataForInserting(message_id)};
+
+        mdsm::Collection response;
+
+        response.resize(prepared_message_id.size() + size);
+
+        std::memcpy(response.getData(), prepared_message_id.data(), prepared_message_id.size());
+
+        if(size > 0)
+        {
+            std::memcpy(response.getData() + prepared_message_id.size(), buffer->getData() + offset, size);
+        }
+
+        complete({}, std::move(response));
+    }
+
+    template <typename MessageIdEnum>
+    bool TcpRemote<MessageIdEnum>::isReceivingEnabled(const MessageIdEnum message_id) const
+    {
+        return mailboxes.contains(message_id) || message_callbacks.find(message_id) != nullptr;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::handleControlFrame(const std::byte* data, const std::size_t size)
+    {
+        if(size == 0)
+        {
+            return;
+        }
+
+        if(static_cast<ControlFrame>(data[0]) == ControlFrame::codecs_announcement && size >= 2)
+        {
+            const std::span<const std::byte> peer_codecs_ids {
+                data + 2, std::min<std::size_t>(static_cast<std::size_t>(data[1]), size - 2)
+            };
+
+            // Our preference order wins
+            for(const auto& codec : compression_codecs)
+            {
+                if(std::ranges::find(peer_codecs_ids, static_cast<std::byte>(codec->getId())) != peer_codecs_ids.end())
+                {
+                    //std::println("DEBUG: Compressing with codec {}", codec->getId());
+
+                    outgoing_codec.store(codec.get(), std::memory_order_release);
+
+                    break;
+                }
+            }
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::announceCodecs()
+    {
+        if(compression_codecs.empty())
+        {
+            // Peers without compression never get control frames
+            return;
+        }
+
+        mdsm::Collection announcement;
+
+        announcement.resize(2 + compression_codecs.size());
+
+        announcement.getData()[0] = static_cast<std::byte>(ControlFrame::codecs_announcement);
+        announcement.getData()[1] = static_cast<std::byte>(compression_codecs.size());
+
+        for(std::size_t i {0}; i < compression_codecs.size(); ++i)
+        {
+            announcement.getData()[2 + i] = static_cast<std::byte>(compression_codecs[i]->getId());
+        }
+
+        enqueueMessage(OutgoingMessage{std::move(announcement), nullptr, nullptr, frame_control_flag}, BlockingMode::overfill);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::compressMessage(OutgoingMessage& outgoing_message) const
+    {
+        const auto codec {outgoing_codec.load(std::memory_order_acquire)};
+
+        // Only the body is compressed, the id staying readable in the header
+        const auto body {outgoing_message.getBody()};
+
+        if(!codec || body.size() < compression_threshold.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        constexpr auto prefix_size {sizeof(CompressionCodecId) + sizeof(mdsm::Collection::Size)};
+
+        mdsm::Collection compressed;
+
+        compressed.resize(prefix_size + codec->getMaxCompressedSize(body.size()));
+
+        const auto compressed_size {
+            codec->compress(
+                body,
+                {compressed.getData() + prefix_size, compressed.getSize() - prefix_size}
+            )
+        };
+
+        if(compressed_size == 0 || prefix_size + compressed_size >= body.size())
+        {
+            // Not worth it: sent as is
+            return;
+        }
+
+        const auto prepared_size {
+            mdsm::Collection::prepareDataForInserting(static_cast<mdsm::Collection::Size>(body.size()))
+        };
+
+        compressed.getData()[0] = static_cast<std::byte>(codec->getId());
+
+        std::memcpy(compressed.getData() + sizeof(CompressionCodecId), prepared_size.data(), prepared_size.size());
+
+        compressed.resize(prefix_size + compressed_size);
+
+        outgoing_message.message     = std::move(compressed);
+        outgoing_message.body_offset  = 0;
+        outgoing_message.flags       |= frame_compressed_flag;
+    }
+
+    template <typename MessageIdEnum>
+    std::optional<mdsm::Collection> TcpRemote<MessageIdEnum>::getSentMessage(const OutgoingMessage& outgoing_message) const
+    {
+        if(!(outgoing_message.flags & frame_compressed_flag))
+        {
+            return outgoing_message.getMessage();
+        }
+
+        // Decompressed again rather than kept along with its compressed frame, as messages rarely fail
+        const auto body {outgoing_message.getBody()};
+
+        constexpr auto prefix_size {sizeof(CompressionCodecId) + sizeof(mdsm::Collection::Size)};
+
+        const auto codec_iter {
+            std::ranges::find_if(
+                compression_codecs,
+                [codec_id = static_cast<CompressionCodecId>(body[0])](const auto& codec)
+                {
+                    return codec->getId() == codec_id;
+                }
+            )
+        };
+
+        if(codec_iter == compression_codecs.end())
+        {
+            return std::nullopt;
+        }
+
+        const std::size_t uncompressed_size {
+            mdsm::Collection::prepareDataForExtracting<mdsm::Collection::Size>(body.data() + sizeof(CompressionCodecId))
+        };
+
+        const auto prepared_message_id {
+            mdsm::Collection::prepareDataForInserting(fromWireMessageId<MessageIdEnum>(outgoing_message.message_id))
+        };
+
+        mdsm::Collection message;
+
+        message.resize(prepared_message_id.size() + uncompressed_size);
+
+        std::memcpy(message.getData(), prepared_message_id.data(), prepared_message_id.size());
+
+        const auto is_decompressed {
+            (*codec_iter)->decompress(
+                body.subspan(prefix_size),
+                {message.getData() + prepared_message_id.size(), uncompressed_size}
+            )
+        };
+
+        if(!is_decompressed)
+        {
+            return std::nullopt;
+        }
+
+        return message;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setCompression(
+        std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+        const std::size_t                                    threshold,
+        const nets::DecompressionLimits                      limits
+    )
+    {
+        compression_codecs    = std::move(codecs);
+        compression_threshold = threshold;
+        decompression_limits  = limits;
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::startPinging()
+    {
+        boost::asio::post(
+            socket.get_executor(),
+            [weak_self = this->weak_from_this()]
+            {
+                if(const auto self {weak_self.lock()})
+                {
+                    self->scheduleHeartbeat(self->ping_delay);
+                }
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::scheduleHeartbeat(const PingTime delay)
+    {
+        timer_wheel.cancel(heartbeat_timer);
+
+        heartbeat_timer = timer_wheel.arm(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::max(delay, PingTime{0})),
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), generation = connection_generation]
+            {
+                const auto self {weak_self.lock()};
+
+                if(!self || generation != self->connection_generation || !self->is_connected)
+                {
+                    return;
+                }
+
+                self->heartbeat_timer = {};
+
+                self->sendHeartbeat();
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::sendHeartbeat()
+    {
+        //std::println("DEBUG: Pinging");
+
+        startPing(
+            [weak_self = this->weak_from_this()](const PingResult result)
+            {
+                const auto self {weak_self.lock()};
+
+                if(!self)
+                {
+                    return;
+                }
+
+                if(result.has_value())
+                {
+                    //std::println("DEBUG: Pinging succeeded");
+
+                    if(self->is_connected)
+                    {
+                        self->scheduleHeartbeat(self->ping_delay - result.value());
+                    }
+                }
+                else if(result.error() == PingError::expired)
+                {
+                    //std::println("DEBUG: Pinging timeout");
+
+                    self->is_connected = false;
+
+                    self->cancelTimeouts();
+
+                    self->failReceivers(boost::asio::error::timed_out);
+                    self->failPendingRequests(boost::asio::error::timed_out);
+
+                    self->reportConnectionLost(boost::asio::error::timed_out);
+
+                    if(self->onPingingTimeout)
+                    {
+                        self->dispatchHandler(
+                            [self]
+                            {
+                                self->onPingingTimeout();
+                            }
+                        );
+                    }
+                }
+                else 
+                {
+                    //std::println("DEBUG: Failed sending ping");
+
+                    self->is_connected = false;
+
+                    self->reportConnectionLost(boost::asio::error::not_connected);
+
+                    if(self->onFailedReading)
+                    {
+                        self->dispatchHandler(
+                            [self]
+                            {
+                                self->onFailedReading(std::nullopt);
+                            }
+                        );
+                    }
+                }
+            }
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::startPing(std::move_only_function<void(PingResult)> complete)
+    {
+        if(!is_connected)
+        {
+            complete(std::unexpected(PingError::failed_to_send));
+
+            return;
+        }
+
+        const auto sequence {next_ping_sequence++};
+
+        auto& pending_ping {pending_pings[sequence]};
+
+        pending_ping.sent_time = std::chrono::steady_clock::now();
+        pending_ping.complete  = std::move(complete);
+
+        auto ping_request {
+            makeOutgoingMessage(std::move(mdsm::Collection{} << MessageIdEnum::ping_request << sequence))
+        };
+
+        // Pings bypass the queue limits, but are accounted for like any other message
+        reserveQueueSpace(getFrameSize(ping_request), false);
+
+        sendMessageToQueue(std::move(ping_request));
+
+        pending_ping.timeout_timer = timer_wheel.arm(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(ping_timeout_period),
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), sequence]
+            {
+                const auto self {weak_self.lock()};
+
+                if(!self)
+                {
+                    return;
+                }
+
+                const auto pending_ping_iter {self->pending_pings.find(sequence)};
+
+                if(pending_ping_iter != self->pending_pings.end())
+                {
+                    auto complete {std::move(pending_ping_iter->second.complete)};
+
+                    self->pending_pings.erase(pending_ping_iter);
+
+                    complete(std::unexpected(PingError::expired));
+                }
+            }
+        );
+    }
 
-                read_message_data.resize(message_size);
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::handlePingResponse(const nets::PingSequence sequence)
+    {
+        const auto pending_ping_iter {pending_pings.find(sequence)};
 
-                boost::asio::async_read(
-                    socket,
-                    boost::asio::buffer(read_message_data.getData(), message_size),
-                    [&, this](const boost::system::error_code error, const std::size_t bytes_count)
-                    {
-                        if(error)
-                        {
-                            is_connected = false;
+        if(pending_ping_iter == pending_pings.end())
+        {
+            // Late reply to an expired ping
+            return;
+        }
 
-                            if(onFailedReading)
-                            {
-                                std::thread {
-                                    onFailedReading, error
-                                }.detach();
-                            }
+        const PingTime ping_time {std::chrono::steady_clock::now() - pending_ping_iter->second.sent_time};
 
-                            return;
-                        }
+        auto complete {std::move(pending_ping_iter->second.complete)};
+
+        timer_wheel.cancel(pending_ping_iter->second.timeout_timer);
+
+        pending_pings.erase(pending_ping_iter);
+
+        last_ping_time = ping_time;
+
+        ping_statistics.record(ping_time);
+
+        metrics.recordPingTime(std::chrono::duration_cast<std::chrono::nanoseconds>(ping_time));
+
+        complete(ping_time);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failPendingPings(const nets::PingError error)
+    {
+        auto failed_pings {std::move(pending_pings)};
+
+        pending_pings.clear();
+
+        for(auto& [sequence, pending_ping] : failed_pings)
+        {
+            timer_wheel.cancel(pending_ping.timeout_timer);
+
+            pending_ping.complete(std::unexpected(error));
+        }
+    }
+
+    template <typename MessageIdEnum>
+    typename TcpRemote<MessageIdEnum>::PingTime TcpRemote<MessageIdEnum>::getLastPingTime() const
+    {
+        return last_ping_time.load();
+    }
 
-                        //std::println("DEBUG: Reading message body");
+    template <typename MessageIdEnum>
+    PingStatistics TcpRemote<MessageIdEnum>::getPingStatistics() const
+    {
+        return ping_statistics.getStatistics();
+    }
+
+    template <typename MessageIdEnum>
+    nets::MetricsSnapshot TcpRemote<MessageIdEnum>::getMetrics() const
+    {
+        auto snapshot {metrics.getSnapshot()};
+
+        snapshot.queued_bytes    = queued_bytes.load(std::memory_order_relaxed);
+        snapshot.queued_messages = queued_messages.load(std::memory_order_relaxed);
+
+        return snapshot;
+    }
+
+    template <typename MessageIdEnum>
+    template <typename CompletionToken>
+    auto TcpRemote<MessageIdEnum>::asyncPing(CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(PingResult)>(
+            [self = this->shared_from_this()](auto handler)
+            {
+                // The result is delivered on the handler's associated executor
+                auto complete {makeCompletion<PingResult>(std::move(handler), self->socket.get_executor())};
+
+                boost::asio::post(
+                    self->socket.get_executor(),
+                    [self, complete = std::move(complete)]() mutable
+                    {
+                        self->startPing(std::move(complete));
+                    }
+                );
+            },
+            token
+        );
+    }
+
+    template <typename MessageIdEnum>
+    template <typename CompletionToken>
+    auto TcpRemote<MessageIdEnum>::asyncSend(mdsm::Collection message, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [self = this->shared_from_this()](auto handler, mdsm::Collection message)
+            {
+                self->enqueueMessage(
+                    makeOutgoingMessage(
+                        std::move(message),
+                        makeCompletion<boost::system::error_code>(std::move(handler), self->socket.get_executor())
+                    ),
+                    BlockingMode::overfill
+                );
+            },
+            token,
+            std::move(message)
+        );
+    }
+
+    template <typename MessageIdEnum>
+    template <typename CompletionToken>
+    auto TcpRemote<MessageIdEnum>::receive(const MessageIdEnum message_id, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, mdsm::Collection)>(
+            [self = this->shared_from_this(), message_id](auto handler)
+            {
+                auto complete {
+                    makeCompletion<boost::system::error_code, mdsm::Collection>(
+                        std::move(handler), self->socket.get_executor()
+                    )
+                };
 
-                        const auto message_id {
-                            read_message_data.retrieve<MessageIdEnum>()
-                        };
+                boost::asio::post(
+                    self->socket.get_executor(),
+                    [self, message_id, complete = std::move(complete)]() mutable
+                    {
+                        auto& mailbox {self->mailboxes[message_id]};
 
-                        if(message_callbacks.contains(message_id))
+                        if(!mailbox.messages.empty())
                         {
-                            if(message_callbacks[message_id].second)
-                            {
-                                //std::println("DEBUG: Callback is being called - Message ID = {}", static_cast<std::size_t>(message_id));
+                            auto message {std::move(mailbox.messages.front())};
 
-                                std::thread {
-                                    message_callbacks[message_id].first,
-                                    read_message_data,
-                                    std::ref(*this)
-                                }.detach();
-                            }
-                            else
-                            {
-                                // Callback is disabled
-                            }
+                            mailbox.messages.pop_front();
+
+                            complete({}, std::move(message));
+                        }
+                        else if(!self->is_connected)
+                        {
+                            complete(boost::asio::error::not_connected, {});
                         }
                         else 
                         {
-                            // No callback found for received message id
+                            mailbox.receivers.push_back(std::move(complete));
                         }
-
-                        startMessagesListener();
                     }
+                );
+            },
+            token
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failReceivers(const boost::system::error_code error)
+    {
+        // Messages already received are kept
+        for(auto& [message_id, mailbox] : mailboxes)
+        {
+            auto failed_receivers {std::move(mailbox.receivers)};
 
+            mailbox.receivers.clear();
+
+            for(auto& complete : failed_receivers)
+            {
+                complete(error, {});
+            }
+        }
+    }
+
+    template <typename MessageIdEnum>
+    template <typename CompletionToken>
+    auto TcpRemote<MessageIdEnum>::request(
+        mdsm::Collection                          message,
+        const std::chrono::steady_clock::duration timeout,
+        CompletionToken&&                         token
+    )
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, mdsm::Collection)>(
+            [self = this->shared_from_this(), timeout](auto handler, mdsm::Collection message)
+            {
+                auto complete {
+                    makeCompletion<boost::system::error_code, mdsm::Collection>(
+                        std::move(handler), self->socket.get_executor()
+                    )
+                };
+
+                boost::asio::post(
+                    self->socket.get_executor(),
+                    [self, timeout, message = std::move(message), complete = std::move(complete)]() mutable
+                    {
+                        self->startRequest(std::move(message), timeout, std::move(complete));
+                    }
                 );
+            },
+            token,
+            std::move(message)
+        );
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::startRequest(
+        mdsm::Collection                          message,
+        const std::chrono::steady_clock::duration timeout,
+        ReceiveCompletion                         complete
+    )
+    {
+        if(!is_connected)
+        {
+            complete(boost::asio::error::not_connected, {});
+
+            return;
+        }
+
+        auto outgoing_message {makeOutgoingMessage(std::move(message))};
+
+        if(outgoing_message.body_offset == 0)
+        {
+            // Malformed message, without id
+            complete(boost::asio::error::invalid_argument, {});
+
+            return;
+        }
+
+        const auto request_id {next_request_id++};
+
+        outgoing_message.flags       = frame_correlated_flag;
+        outgoing_message.correlation = encodeCorrelation(request_id, CorrelationKind::request);
+
+        // Like asyncSend(), requests never block
+        const auto status {enqueueMessage(std::move(outgoing_message), BlockingMode::overfill)};
+
+        if(status != SendStatus::queued)
+        {
+            complete(
+                status == SendStatus::queue_full ? boost::asio::error::no_buffer_space : boost::asio::error::not_connected,
+                {}
+            );
+
+            return;
+        }
+
+        auto& pending_request {pending_requests[request_id]};
+
+        pending_request.complete       = std::move(complete);
+        pending_request.deadline_timer = timer_wheel.arm(
+            timeout,
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), request_id]
+            {
+                if(const auto self {weak_self.lock()})
+                {
+                    self->expireRequest(request_id);
+                }
             }
         );
     }
 
     template <typename MessageIdEnum>
-    void TcpRemote<MessageIdEnum>::startPinging()
+    void TcpRemote<MessageIdEnum>::reply(const nets::RequestId request_id, mdsm::Collection response)
+    {
+        auto outgoing_message {makeOutgoingMessage(std::move(response))};
+
+        outgoing_message.flags       = frame_correlated_flag;
+        outgoing_message.correlation = encodeCorrelation(request_id, CorrelationKind::response);
+
+        // Request handlers may run on the strand, which waiting for queue space would deadlock
+        enqueueMessage(std::move(outgoing_message), BlockingMode::overfill);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::expireRequest(const nets::RequestId request_id)
+    {
+        const auto pending_request_iter {pending_requests.find(request_id)};
+
+        if(pending_request_iter == pending_requests.end())
+        {
+            // Answered while its expiry was posted
+            return;
+        }
+
+        auto complete {std::move(pending_request_iter->second.complete)};
+
+        pending_requests.erase(pending_request_iter);
+
+        complete(boost::asio::error::timed_out, {});
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failPendingRequest(const nets::RequestId request_id, const boost::system::error_code error)
+    {
+        const auto pending_request_iter {pending_requests.find(request_id)};
+
+        if(pending_request_iter == pending_requests.end())
+        {
+            return;
+        }
+
+        auto complete {std::move(pending_request_iter->second.complete)};
+
+        timer_wheel.cancel(pending_request_iter->second.deadline_timer);
+
+        pending_requests.erase(pending_request_iter);
+
+        complete(error, {});
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::failPendingRequests(const boost::system::error_code error)
+    {
+        auto failed_requests {std::move(pending_requests)};
+
+        pending_requests.clear();
+
+        for(auto& [request_id, pending_request] : failed_requests)
+        {
+            timer_wheel.cancel(pending_request.deadline_timer);
+
+            pending_request.complete(error, {});
+        }
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::startTimeouts()
     {
-        std::thread {
-            [&, this]
+        boost::asio::post(
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), generation = connection_generation]
             {
-                while(is_connected)
+                const auto self {weak_self.lock()};
+
+                if(!self || generation != self->connection_generation)
                 {
-                    //std::println("DEBUG: Pinging");
+                    return;
+                }
 
-                    const auto pinging_result {ping()};
+                self->last_receive_time = std::chrono::steady_clock::now();
 
-                    if(!pinging_result.has_value())
-                    {
-                        //std::println("DEBUG: pinging_result doesn't have value");
+                if(self->timeouts.idle > std::chrono::milliseconds{0})
+                {
+                    self->armIdleTimer(self->timeouts.idle);
+                }
 
-                        if(pinging_result.error() == PingError::expired)
+                if(self->timeouts.handshake > std::chrono::milliseconds{0} && !self->has_received)
+                {
+                    self->handshake_timer = self->timer_wheel.arm(
+                        self->timeouts.handshake,
+                        self->socket.get_executor(),
+                        [weak_self, generation]
                         {
-                            //std::println("DEBUG: Pinging timeout");
+                            const auto self {weak_self.lock()};
 
-                            is_connected = false;
-
-                            if(onPingingTimeout)
+                            if(self && generation == self->connection_generation && self->is_connected && !self->has_received)
                             {
-                                onPingingTimeout();
+                                //std::println("DEBUG: Handshake timeout");
+
+                                self->closeOnTimeout();
                             }
                         }
-                        else 
-                        {
-                            //std::println("DEBUG: Failed sending ping");
+                    );
+                }
+            }
+        );
+    }
 
-                            is_connected = false;
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::cancelTimeouts()
+    {
+        timer_wheel.cancel(idle_timer);
+        timer_wheel.cancel(write_stall_timer);
+        timer_wheel.cancel(handshake_timer);
+    }
 
-                            if(onFailedReading)
-                            {
-                                onFailedReading(std::nullopt);
-                            }
-                        }
-                    }
-                    else 
-                    {
-                        // Ping response received successfully
-                        
-                        //std::println("DEBUG: Pinging succeeded");
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::armIdleTimer(const std::chrono::steady_clock::duration delay)
+    {
+        idle_timer = timer_wheel.arm(
+            delay,
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), generation = connection_generation]
+            {
+                const auto self {weak_self.lock()};
 
-                        is_connected = true;
-                    }
+                if(!self || generation != self->connection_generation || !self->is_connected)
+                {
+                    return;
+                }
 
-                    std::this_thread::sleep_for(
-                        ping_delay - (pinging_result.has_value() ? pinging_result.value() : PingTime{0})
-                    );
+                self->idle_timer = {};
+
+                const auto idle_time {std::chrono::steady_clock::now() - self->last_receive_time};
+
+                if(idle_time >= self->timeouts.idle)
+                {
+                    //std::println("DEBUG: Idle timeout");
+
+                    self->closeOnTimeout();
+                }
+                else 
+                {
+                    // Received since armed: armed again for what's left since the last read
+                    self->armIdleTimer(self->timeouts.idle - idle_time);
                 }
             }
-        }.detach();
+        );
     }
 
     template <typename MessageIdEnum>
-    std::expected<typename TcpRemote<MessageIdEnum>::PingTime, nets::PingError>
-        TcpRemote<MessageIdEnum>::ping(const PingTime period)
+    void TcpRemote<MessageIdEnum>::armWriteStallTimer(const std::chrono::steady_clock::duration delay)
     {
-        try
-        {
-            send(mdsm::Collection{} << MessageIdEnum::ping_request);
+        write_stall_timer = timer_wheel.arm(
+            delay,
+            socket.get_executor(),
+            [weak_self = this->weak_from_this(), generation = connection_generation]
+            {
+                const auto self {weak_self.lock()};
+
+                if(!self || generation != self->connection_generation || !self->is_connected)
+                {
+                    return;
+                }
 
-            const auto ping_sent_time {std::chrono::system_clock::now()};
+                self->write_stall_timer = {};
 
-            while(!ping_response_received.load())
-            {
-                if((ping_sent_time + ping_timeout_period) <= std::chrono::system_clock::now())
+                if(!self->is_writing)
                 {
-                    //std::println("DEBUG: Inside Ping Expired if");
+                    // Armed again by the next write
+                    return;
+                }
 
-                    ping_response_received = false;
+                const auto write_time {std::chrono::steady_clock::now() - self->write_start_time};
 
-                    return std::unexpected(PingError::expired);
+                if(write_time >= self->timeouts.write_stall)
+                {
+                    //std::println("DEBUG: Write stalled");
+
+                    self->closeOnTimeout();
+                }
+                else 
+                {
+                    self->armWriteStallTimer(self->timeouts.write_stall - write_time);
                 }
             }
+        );
+    }
 
-            //std::println("DEBUG: Exited ping while loop");
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::closeOnTimeout()
+    {
+        closing_error = boost::asio::error::timed_out;
 
-            return std::chrono::system_clock::now() - ping_sent_time;
-        }
-        catch(const boost::exception& e)
-        {
-            ping_response_received = false;
+        boost::system::error_code ignored_error;
 
-            return std::unexpected(PingError::failed_to_send);
-        }
+        // Ends the pending read, which reports the connection lost
+        socket.close(ignored_error);
+    }
+
+    template <typename MessageIdEnum>
+    std::expected<typename TcpRemote<MessageIdEnum>::PingTime, nets::PingError>
+        TcpRemote<MessageIdEnum>::ping(const PingTime period)
+    {
+        return asyncPing(boost::asio::use_future).get();
     }
 
     template <typename MessageIdEnum>
@@ -501,7 +2758,32 @@ namespace nets
         const bool enabled
     )
     {
-        message_callbacks[message_id].first = callback;
-        message_callbacks[message_id].second = enabled;
+        message_callbacks.set(message_id, MessageHandler{.callback = callback}, enabled);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setOnRequest(
+        const MessageIdEnum message_id,
+        const RequestReceivedCallback& callback,
+        const bool enabled
+    )
+    {
+        message_callbacks.set(message_id, MessageHandler{.request_callback = callback}, enabled);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setReceivingEnabled(const MessageIdEnum message_id, const bool enabled)
+    {
+        message_callbacks.setEnabled(message_id, enabled);
+    }
+
+    template <typename MessageIdEnum>
+    void TcpRemote<MessageIdEnum>::setOnReceivingView(
+        const MessageIdEnum message_id,
+        const MessageViewReceivedCallback& callback,
+        const bool enabled
+    )
+    {
+        message_callbacks.set(message_id, MessageHandler{.view_callback = callback}, enabled);
     }
 }
\ No newline at end of file
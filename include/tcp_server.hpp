@@ -2,9 +2,18 @@
 
 #include "types.hpp"
 #include "../include/tcp_remote.hpp"
+#include "handler_dispatcher.hpp"
+#include "buffer_pool.hpp"
+#include "frame.hpp"
+#include "client_registry.hpp"
+#include "object_pool.hpp"
+#include "compression.hpp"
+#include "metrics.hpp"
 
 #include <functional>
 #include <list>
+#include <algorithm>
+#include <concepts>
 
 namespace nets
 {
@@ -15,8 +24,10 @@ namespace nets
             using PingTime = Remote::PingTime;
 
             TcpServer(
-                const PingTime ping_timeout_period = PingTime{2},
-                const PingTime ping_delay          = PingTime{4}           
+                const PingTime            ping_timeout_period = PingTime{2},
+                const PingTime            ping_delay          = PingTime{4},
+                const std::size_t         io_threads_count    = 1,
+                const nets::ListeningMode listening_mode      = nets::ListeningMode::single_acceptor
             );          
 
             TcpServer(const TcpServer&) = delete;
@@ -34,7 +45,44 @@ namespace nets
             nets::IPVersion  getIpVersion();
             nets::Port       getPort();
 
-            virtual void onClientConnection(std::shared_ptr<Remote> client) = 0;
+            // Selects how clients' message handlers are run; affects connections accepted afterwards,
+            // those accepted before keeping the previous dispatcher until the server is destroyed
+            void setHandlerDispatch(
+                const nets::HandlerDispatch mode,
+                const std::size_t           workers_count = HandlerDispatcher::defaultWorkersCount()
+            );
+
+            nets::HandlerDispatch getHandlerDispatch() const;
+
+            // Number of accept operations kept in flight, so that bursts of connections
+            // aren't served one completion at a time. Applied by startAccepting()
+            void setPendingAcceptsCount(const std::size_t pending_accepts_count);
+
+            // Backlog of the listening socket. Applied by startAccepting()
+            void setListenBacklog(const int listen_backlog);
+
+            // Compression of the messages exchanged with clients accepted afterwards (see TcpRemote::setCompression())
+            void setCompression(
+                std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+                const std::size_t                                    threshold = 1024,
+                const nets::DecompressionLimits                      limits    = {}
+            );
+
+            // Idle, write stall and handshake timeouts of clients accepted afterwards (see TcpRemote::setTimeouts())
+            void setConnectionTimeouts(const nets::ConnectionTimeouts timeouts);
+
+            // Largest frame accepted from clients accepted afterwards (see TcpRemote::setMaxReceivedFrameSize())
+            void setMaxReceivedFrameSize(const std::size_t size);
+
+            std::size_t getPendingAcceptsCount() const;
+            int         getListenBacklog()       const;
+
+            // Runs on its own thread for each accepted client, unless onClientSession() is overridden
+            virtual void onClientConnection(std::shared_ptr<Remote> client) {};
+
+            // Coroutine run on the client's strand once it's connected, so that sessions don't need
+            // a thread each. By default it runs onClientConnection() on a detached thread
+            virtual boost::asio::awaitable<void> onClientSession(std::shared_ptr<Remote> client);
             
             // Client connected when server wasn't accepting requests
             virtual void onForbiddenClientConnection(std::shared_ptr<Remote> client) = 0; 
@@ -42,32 +90,119 @@ namespace nets
             bool closeConnection(std::shared_ptr<Remote> client);
             void closeAllConnections();
 
+            // Frame the message once and queue the same shared frame to every connected client
+            // (or to the selected ones), returning how many clients it was queued to.
+            // Never blocks: clients whose queue is full skip the message, even with the block
+            // backpressure policy, so one slow client doesn't hold up the others
+            std::size_t broadcast(mdsm::Collection message);
+
+            template <typename Predicate>
+                requires std::predicate<Predicate&, const std::shared_ptr<Remote>&>
+            std::size_t multicast(Predicate&& predicate, mdsm::Collection message);
+
+            std::size_t multicast(const std::vector<std::shared_ptr<Remote>>& targets, mdsm::Collection message);
+
             size_t getClientsCount();
 
-            std::vector<std::shared_ptr<Remote>>&       getClients();
-            const std::vector<std::shared_ptr<Remote>>& getClients() const;
+            std::size_t getIoThreadsCount() const;
+
+            nets::ListeningMode getListeningMode() const;
+
+            using ClientsSnapshot = typename nets::ClientRegistry<Remote>::Snapshot;
+
+            // Immutable view of the connected clients, safe to iterate while clients come and go
+            ClientsSnapshot getClients() const;
+
+            // Returns nullptr if no client with such id is connected
+            std::shared_ptr<Remote> getClient(const nets::ConnectionId id) const;
+
+            // Connections counters, and the metrics of every connection since the server started
+            nets::ServerMetricsSnapshot getMetrics() const;
+
+            // getMetrics() in Prometheus text format, followed by the metrics of each connected client
+            // (labeled with its connection id) if `per_connection`
+            std::string getPrometheusMetrics(const bool per_connection = false) const;
 
             virtual ~TcpServer();
         
         private:
+            // Declared before the io_contexts, so that worker pools outlive every remote using their strands,
+            // those left in pending handlers included
+            mutable std::mutex                              handler_dispatchers_mutex;
+            std::shared_ptr<HandlerDispatcher>              handler_dispatcher;
+            std::vector<std::shared_ptr<HandlerDispatcher>> retired_handler_dispatchers;
+
             boost::asio::io_context        server_io_context;
-            std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+
+            nets::ListeningMode listening_mode;
+
+            // Sharded listening only: the io_context of each shard
+            std::vector<std::unique_ptr<boost::asio::io_context>> shards_io_contexts;
+
+            // Threads running either server_io_context or a shard's io_context each,
+            // joined before the io_contexts are destroyed
+            std::vector<std::thread> io_threads;
+
+            struct AcceptorShard
+            {
+                boost::asio::io_context&                        io_context;
+                std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+            };
+
+            // A single one unless listening is sharded
+            std::vector<AcceptorShard> acceptor_shards;
+
+        #if defined(SO_REUSEPORT)
+            using ReusePortOption = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+        #endif
 
             std::string address;
             IPVersion   ip_version;
             nets::Port  port;
 
-            std::vector<std::shared_ptr<Remote>> clients;
+            nets::ClientRegistry<Remote> clients;
             
-            bool is_accepting {false};
+            std::atomic_bool is_accepting {false};
 
             PingTime ping_timeout_time;
             PingTime ping_delay;
 
-            void accept();
+            std::size_t io_threads_count;
+
+            // Receive buffers are shared by all the clients
+            std::shared_ptr<BufferPool> buffer_pool;
+
+            // Remotes are built only once a connection is accepted, in recycled memory
+            std::shared_ptr<ObjectPool> remote_pool;
+
+            std::vector<std::shared_ptr<const CompressionCodec>> compression_codecs;
+            std::size_t                                          compression_threshold {1024};
+            nets::DecompressionLimits                            decompression_limits;
+
+            nets::ConnectionTimeouts connection_timeouts;
+
+            std::size_t max_received_frame_size {nets::default_max_received_frame_size};
+
+            std::atomic_uint64_t connections_accepted {0};
+            std::atomic_uint64_t connections_closed   {0};
+            std::atomic_uint64_t accept_errors        {0};
+
+            // Metrics of the closed connections, which aren't in the registry anymore
+            mutable std::mutex    closed_connections_metrics_mutex;
+            nets::MetricsSnapshot closed_connections_metrics;
+
+            void retireConnectionMetrics(const Remote& client);
+
+            std::size_t pending_accepts_count {1};
+            int         listen_backlog        {boost::asio::socket_base::max_listen_connections};
+
+            // Delay before accepting again after an error such as EMFILE, so that it doesn't spin
+            static constexpr std::chrono::milliseconds accept_retry_delay {100};
+
+            void accept(const std::size_t shard_index);
 
             void handleAccepting(
-                std::shared_ptr<Remote>   client,
+                const std::size_t         shard_index,
                 boost::system::error_code error,
                 nets::TcpSocket           socket
             );
@@ -84,21 +219,59 @@ namespace nets
 {
     template <typename MessageIdEnum, typename Remote>
     TcpServer<MessageIdEnum, Remote>::TcpServer(
-        const PingTime ping_timeout_time,
-        const PingTime ping_delay
+        const PingTime            ping_timeout_time,
+        const PingTime            ping_delay,
+        const std::size_t         io_threads_count,
+        const nets::ListeningMode listening_mode
     )
     :
-        server_io_context{},
+        handler_dispatcher{std::make_shared<HandlerDispatcher>()},
+        server_io_context{static_cast<int>(std::max<std::size_t>(io_threads_count, 1))},
+        listening_mode{listening_mode},
         ping_timeout_time{ping_timeout_time},
         ping_delay{ping_delay},
+        io_threads_count{std::max<std::size_t>(io_threads_count, 1)},
+        buffer_pool{std::make_shared<BufferPool>()},
+        remote_pool{std::make_shared<ObjectPool>()},
         server_io_context_work{server_io_context.get_executor()}
     {
-        std::thread {    
-            [&, this]
+        if(listening_mode == nets::ListeningMode::sharded_acceptors)
+        {
+            // Each shard accepts and serves its connections on its own thread
+            for(std::size_t i {0}; i < this->io_threads_count; ++i)
             {
-                server_io_context.run();
+                auto& shard_io_context {
+                    *shards_io_contexts.emplace_back(std::make_unique<boost::asio::io_context>())
+                };
+
+                acceptor_shards.push_back(AcceptorShard{shard_io_context, nullptr});
+
+                io_threads.emplace_back(
+                    [&shard_io_context]
+                    {
+                        const auto work {boost::asio::make_work_guard(shard_io_context)};
+
+                        shard_io_context.run();
+                    }
+                );
             }
-        }.detach();
+        }
+        else
+        {
+            acceptor_shards.push_back(AcceptorShard{server_io_context, nullptr});
+
+            // Every connection is bound to its own strand, so the io_context
+            // can safely be run by a pool of threads
+            for(std::size_t i {0}; i < this->io_threads_count; ++i)
+            {
+                io_threads.emplace_back(
+                    [this]
+                    {
+                        server_io_context.run();
+                    }
+                );
+            }
+        }
     }  
 
     template <typename MessageIdEnum, typename Remote>
@@ -108,28 +281,54 @@ namespace nets
         {
             is_accepting = true;
 
-            if(address == "")
-            {
-                acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(
-                    server_io_context,
+            const auto endpoint {
+                address == "" ?
                     boost::asio::ip::tcp::endpoint{
                         ip_version == IPVersion::ipv4 ? boost::asio::ip::tcp::v4() : boost::asio::ip::tcp::v6(),
                         port
                     }
-                );
-            }
-            else 
-            {
-                acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(
-                    server_io_context,
+                :
                     boost::asio::ip::tcp::endpoint{
                         boost::asio::ip::make_address(address),
                         port
                     }
+            };
+
+            for(std::size_t shard_index {0}; shard_index < acceptor_shards.size(); ++shard_index)
+            {
+                auto& shard {acceptor_shards[shard_index]};
+
+                shard.acceptor = std::make_shared<boost::asio::ip::tcp::acceptor>(
+                    boost::asio::make_strand(shard.io_context)
                 );
-            }
 
-            accept();
+                shard.acceptor->open(endpoint.protocol());
+                shard.acceptor->set_option(boost::asio::socket_base::reuse_address{true});
+
+                if(listening_mode == nets::ListeningMode::sharded_acceptors)
+                {
+                #if defined(SO_REUSEPORT)
+                    // The kernel spreads incoming connections over the shards' acceptors
+                    shard.acceptor->set_option(ReusePortOption{true});
+                #else
+                    // Without SO_REUSEPORT only the first shard can listen
+                    if(shard_index > 0)
+                    {
+                        shard.acceptor.reset();
+
+                        continue;
+                    }
+                #endif
+                }
+
+                shard.acceptor->bind(endpoint);
+                shard.acceptor->listen(listen_backlog);
+
+                for(std::size_t i {0}; i < pending_accepts_count; ++i)
+                {
+                    accept(shard_index);
+                }
+            }
 
             return true;
         }
@@ -146,9 +345,12 @@ namespace nets
         {
             boost::system::error_code error;
 
-            if(acceptor->is_open())
+            for(auto& shard : acceptor_shards)
             {
-                acceptor->close(error);
+                if(shard.acceptor && shard.acceptor->is_open())
+                {
+                    shard.acceptor->close(error);
+                }
             }
 
             return !(is_accepting = false) && !error;
@@ -196,24 +398,92 @@ namespace nets
     }
 
     template <typename MessageIdEnum, typename Remote>
-    void TcpServer<MessageIdEnum, Remote>::accept()
+    void TcpServer<MessageIdEnum, Remote>::setHandlerDispatch(
+        const nets::HandlerDispatch mode,
+        const std::size_t           workers_count
+    )
+    {
+        auto dispatcher {std::make_shared<HandlerDispatcher>(mode, workers_count)};
+
+        const std::lock_guard lock {handler_dispatchers_mutex};
+
+        // Connected clients still run their handlers on the previous dispatcher's strands
+        retired_handler_dispatchers.push_back(std::exchange(handler_dispatcher, std::move(dispatcher)));
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::HandlerDispatch TcpServer<MessageIdEnum, Remote>::getHandlerDispatch() const
+    {
+        const std::lock_guard lock {handler_dispatchers_mutex};
+
+        return handler_dispatcher->getMode();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::setPendingAcceptsCount(const std::size_t t_pending_accepts_count)
+    {
+        pending_accepts_count = std::max<std::size_t>(t_pending_accepts_count, 1);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::setListenBacklog(const int t_listen_backlog)
+    {
+        listen_backlog = t_listen_backlog;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::setCompression(
+        std::vector<std::shared_ptr<const CompressionCodec>> codecs,
+        const std::size_t                                    threshold,
+        const nets::DecompressionLimits                      limits
+    )
+    {
+        compression_codecs    = std::move(codecs);
+        compression_threshold = threshold;
+        decompression_limits  = limits;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::setConnectionTimeouts(const nets::ConnectionTimeouts timeouts)
+    {
+        connection_timeouts = timeouts;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::setMaxReceivedFrameSize(const std::size_t size)
+    {
+        max_received_frame_size = size;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpServer<MessageIdEnum, Remote>::getPendingAcceptsCount() const
+    {
+        return pending_accepts_count;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    int TcpServer<MessageIdEnum, Remote>::getListenBacklog() const
+    {
+        return listen_backlog;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::accept(const std::size_t shard_index)
     {
         if(is_accepting)
         {
             //std::println("DEBUG: Accepting");
 
-            clients.push_back(
-                std::make_shared<Remote>(
-                    server_io_context, ping_timeout_time, ping_delay
-                )
-            ); 
+            // The accepted socket is bound to its own strand,
+            // which becomes the connection's strand
+            auto& shard {acceptor_shards[shard_index]};
 
-            acceptor->async_accept(
-                boost::asio::make_strand(acceptor->get_executor()),
+            shard.acceptor->async_accept(
+                boost::asio::make_strand(shard.io_context),
                 std::bind(
                     &TcpServer<MessageIdEnum, Remote>::handleAccepting,
                     this,
-                    clients.back(),
+                    shard_index,
                     std::placeholders::_1,
                     std::placeholders::_2
                 )
@@ -223,25 +493,59 @@ namespace nets
 
     template <typename MessageIdEnum, typename Remote>
     void TcpServer<MessageIdEnum, Remote>::handleAccepting(
-        std::shared_ptr<Remote> client,
+        const std::size_t         shard_index,
         boost::system::error_code error,
-        nets::TcpSocket socket
+        nets::TcpSocket           socket
     )
     {
         if(!error)
         {
-            client->getSocket() = std::move(socket);
+            connections_accepted.fetch_add(1, std::memory_order_relaxed);
+
+            const auto client {
+                remote_pool->make<Remote>(
+                    acceptor_shards[shard_index].io_context, std::move(socket), ping_timeout_time, ping_delay
+                )
+            };
+
+            {
+                const std::lock_guard lock {handler_dispatchers_mutex};
+
+                client->setHandlerExecutor(
+                    handler_dispatcher->makeConnectionExecutor(client->getSocket().get_executor())
+                );
+            }
+
+            client->setBufferPool(buffer_pool);
+
+            client->setCompression(compression_codecs, compression_threshold, decompression_limits);
+
+            client->setTimeouts(connection_timeouts);
+
+            client->setMaxReceivedFrameSize(max_received_frame_size);
 
             if(is_accepting)
             {
                 //std::println("DEBUG: Accepted connection");
-                accept();
-
-                client->start();          
-                
-                std::thread {
-                    &TcpServer::onClientConnection, this, client
-                }.detach();
+                accept(shard_index);
+
+                // Start on the connection's strand, and only then publish the client, so that
+                // broadcasts from other threads can't reach it while its state is being reset
+                boost::asio::dispatch(
+                    client->getSocket().get_executor(),
+                    [this, client]
+                    {
+                        client->start();
+
+                        clients.insert(client);
+
+                        boost::asio::co_spawn(
+                            client->getSocket().get_executor(),
+                            onClientSession(client),
+                            boost::asio::detached
+                        );
+                    }
+                );
             }
             else
             {
@@ -250,45 +554,152 @@ namespace nets
                 }.detach();
             }
         }
-        else
+        else if(error != boost::asio::error::operation_aborted)
         {
-            // Error occourred
+            accept_errors.fetch_add(1, std::memory_order_relaxed);
+
+            // Error occourred: keep the pending accepts count steady
+            if(error == boost::asio::error::connection_aborted)
+            {
+                // The peer gave up before being accepted: nothing wrong with the acceptor
+                accept(shard_index);
+            }
+            else 
+            {
+                // Out of descriptors or buffers, which retrying at once wouldn't fix
+                auto& shard {acceptor_shards[shard_index]};
+
+                boost::asio::use_service<nets::TimerWheel>(shard.io_context).arm(
+                    accept_retry_delay,
+                    shard.acceptor->get_executor(),
+                    [this, shard_index]
+                    {
+                        accept(shard_index);
+                    }
+                );
+            }
         }
     }
 
+    template <typename MessageIdEnum, typename Remote>
+    boost::asio::awaitable<void> TcpServer<MessageIdEnum, Remote>::onClientSession(std::shared_ptr<Remote> client)
+    {
+        std::thread {
+            &TcpServer::onClientConnection, this, client
+        }.detach();
+
+        co_return;
+    }
+
     template <typename MessageIdEnum, typename Remote>
     size_t TcpServer<MessageIdEnum, Remote>::getClientsCount()
     {
-        return clients.size();
+        return clients.getSize();
     }
 
     template <typename MessageIdEnum, typename Remote>
-    std::vector<std::shared_ptr<Remote>>& TcpServer<MessageIdEnum, Remote>::getClients()
+    std::size_t TcpServer<MessageIdEnum, Remote>::getIoThreadsCount() const
     {
-        return clients;
+        return io_threads_count;
     }
 
     template <typename MessageIdEnum, typename Remote>
-    const std::vector<std::shared_ptr<Remote>>& TcpServer<MessageIdEnum, Remote>::getClients() const
+    nets::ListeningMode TcpServer<MessageIdEnum, Remote>::getListeningMode() const
     {
-        return clients;
-    }    
+        return listening_mode;
+    }
 
     template <typename MessageIdEnum, typename Remote>
-    bool TcpServer<MessageIdEnum, Remote>::closeConnection(std::shared_ptr<Remote> client)
+    typename TcpServer<MessageIdEnum, Remote>::ClientsSnapshot TcpServer<MessageIdEnum, Remote>::getClients() const
     {
-        const auto client_iter {
-            std::find(clients.begin(), clients.end(), client)
-        };
+        return clients.getSnapshot();
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::shared_ptr<Remote> TcpServer<MessageIdEnum, Remote>::getClient(const nets::ConnectionId id) const
+    {
+        return clients.find(id);
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    nets::ServerMetricsSnapshot TcpServer<MessageIdEnum, Remote>::getMetrics() const
+    {
+        nets::ServerMetricsSnapshot snapshot;
+
+        snapshot.connections_accepted = connections_accepted.load(std::memory_order_relaxed);
+        snapshot.connections_closed   = connections_closed.load(std::memory_order_relaxed);
+        snapshot.accept_errors        = accept_errors.load(std::memory_order_relaxed);
+
+        const auto clients_snapshot {clients.getSnapshot()};
+
+        snapshot.connections_active = clients_snapshot->size();
 
-        if(client_iter != clients.end())
         {
-            boost::system::error_code error;
+            const std::lock_guard lock {closed_connections_metrics_mutex};
 
-            (*client_iter)->getSocket().shutdown(TcpSocket::shutdown_both);
-            (*client_iter)->getSocket().close(error);
+            snapshot.connections = closed_connections_metrics;
+        }
+
+        for(const auto& client : *clients_snapshot)
+        {
+            snapshot.connections += client->getMetrics();
+        }
 
-            clients.erase(client_iter);
+        return snapshot;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::string TcpServer<MessageIdEnum, Remote>::getPrometheusMetrics(const bool per_connection) const
+    {
+        auto text {formatPrometheus(getMetrics())};
+
+        if(per_connection)
+        {
+            std::vector<nets::LabeledMetricsSnapshot> connections_metrics;
+
+            for(const auto& client : *clients.getSnapshot())
+            {
+                connections_metrics.push_back(
+                    {"connection_id=\"" + std::to_string(client->getId()) + "\"", client->getMetrics()}
+                );
+            }
+
+            text += formatPrometheus(connections_metrics, "nets_connection");
+        }
+
+        return text;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    void TcpServer<MessageIdEnum, Remote>::retireConnectionMetrics(const Remote& client)
+    {
+        connections_closed.fetch_add(1, std::memory_order_relaxed);
+
+        auto client_metrics {client.getMetrics()};
+
+        // Nothing will be written anymore
+        client_metrics.queued_bytes    = 0;
+        client_metrics.queued_messages = 0;
+
+        const std::lock_guard lock {closed_connections_metrics_mutex};
+
+        closed_connections_metrics += client_metrics;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    bool TcpServer<MessageIdEnum, Remote>::closeConnection(std::shared_ptr<Remote> client)
+    {
+        if(client && clients.erase(client->getId()))
+        {
+            retireConnectionMetrics(*client);
+
+            // Cancels the client's timers on its strand, while the io_context is alive
+            client->stop();
+
+            boost::system::error_code error;
+
+            client->getSocket().shutdown(TcpSocket::shutdown_both, error);
+            client->getSocket().close(error);
 
             //std::println("DEBUG: Closing connection");
 
@@ -303,13 +714,83 @@ namespace nets
     template <typename MessageIdEnum, typename Remote>
     void TcpServer<MessageIdEnum, Remote>::closeAllConnections()
     {
-        for(auto& client : clients)
+        for(auto& client : clients.clear())
+        {
+            retireConnectionMetrics(*client);
+
+            client->stop();
+
+            boost::system::error_code error;
+
+            client->getSocket().shutdown(TcpSocket::shutdown_both, error);
+            client->getSocket().close(error);
+        }
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpServer<MessageIdEnum, Remote>::broadcast(mdsm::Collection message)
+    {
+        return multicast(
+            [](const std::shared_ptr<Remote>& client)
+            {
+                return true;
+            },
+            std::move(message)
+        );
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    template <typename Predicate>
+        requires std::predicate<Predicate&, const std::shared_ptr<Remote>&>
+    std::size_t TcpServer<MessageIdEnum, Remote>::multicast(Predicate&& predicate, mdsm::Collection message)
+    {
+        const auto frame {makeSharedFrame<MessageIdEnum>(std::move(message))};
+
+        if(!frame)
+        {
+            return 0;
+        }
+
+        std::size_t targets_count {0};
+
+        for(const auto& client : *clients.getSnapshot())
         {
-            client->getSocket().shutdown(TcpSocket::shutdown_both);
-            client->getSocket().close();
+            if(client->isConnected() && predicate(client))
+            {
+                if(client->trySendNow(frame) == SendStatus::queued)
+                {
+                    ++targets_count;
+                }
+            }
         }
 
-        clients.clear();
+        return targets_count;
+    }
+
+    template <typename MessageIdEnum, typename Remote>
+    std::size_t TcpServer<MessageIdEnum, Remote>::multicast(
+        const std::vector<std::shared_ptr<Remote>>& targets,
+        mdsm::Collection                            message
+    )
+    {
+        const auto frame {makeSharedFrame<MessageIdEnum>(std::move(message))};
+
+        if(!frame)
+        {
+            return 0;
+        }
+
+        std::size_t targets_count {0};
+
+        for(const auto& client : targets)
+        {
+            if(client->isConnected() && client->trySendNow(frame) == SendStatus::queued)
+            {
+                ++targets_count;
+            }
+        }
+
+        return targets_count;
     }
 
     template <typename MessageIdEnum, typename Remote>
@@ -319,5 +800,17 @@ namespace nets
         closeAllConnections();
 
         active = false;
+
+        server_io_context.stop();
+
+        for(auto& shard_io_context : shards_io_contexts)
+        {
+            shard_io_context->stop();
+        }
+
+        for(auto& io_thread : io_threads)
+        {
+            io_thread.join();
+        }
     }
 }   
\ No newline at end of file
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace nets
+{
+    // Hierarchical timer wheel shared by every connection of an io_context, which gets it through
+    // `boost::asio::use_service<nets::TimerWheel>(io_context)`. Arming and cancelling a timer take
+    // constant time, and a single steady_timer wakes the wheel when its next occupied slot is reached, so that
+    // heartbeats, request deadlines and connection timeouts of many connections cost next to nothing.
+    // Expiry is rounded up to the next tick
+    class TimerWheel : public boost::asio::execution_context::service
+    {
+        public:
+            using Callback = std::move_only_function<void()>;
+
+            static constexpr std::chrono::steady_clock::duration tick_duration {std::chrono::milliseconds{10}};
+
+            // Identifies an armed timer. Stale handles (of fired or cancelled timers) are harmless
+            struct TimerHandle
+            {
+                std::uint32_t index      {std::numeric_limits<std::uint32_t>::max()};
+                std::uint32_t generation {0};
+
+                bool isSet() const;
+            };
+
+            static inline boost::asio::execution_context::id id;
+
+            explicit TimerWheel(boost::asio::io_context& io_context);
+
+            // Posts the callback to the executor once the delay has elapsed. Thread safe
+            TimerHandle arm(
+                const std::chrono::steady_clock::duration delay,
+                const boost::asio::any_io_executor&       executor,
+                Callback                                  callback
+            );
+
+            // Returns whether the timer was still armed, its callback then never being called.
+            // Otherwise it may already be posted: callbacks must check that they're still relevant.
+            // The handle is reset either way. Thread safe
+            bool cancel(TimerHandle& handle);
+
+            std::size_t getArmedTimersCount() const;
+
+        private:
+            static constexpr std::size_t   levels_count {4};
+            static constexpr std::size_t   slot_bits    {6};
+            static constexpr std::size_t   slots_count  {1 << slot_bits};
+            static constexpr std::size_t   slot_mask    {slots_count - 1};
+            static constexpr std::uint32_t no_entry     {std::numeric_limits<std::uint32_t>::max()};
+
+            // Timers are kept in a slab, linked into their slot by indexes, and reused once fired or cancelled
+            struct Entry
+            {
+                std::uint64_t expiry_tick {0};
+                std::uint32_t generation  {0};
+                std::uint32_t slot        {0};
+                std::uint32_t previous    {no_entry};
+                std::uint32_t next        {no_entry};
+                bool          is_armed    {false};
+
+                boost::asio::any_io_executor executor;
+                Callback                     callback;
+            };
+
+            mutable std::mutex mutex;
+
+            std::vector<Entry>         entries;
+            std::vector<std::uint32_t> free_entries;
+
+            // Level 0 holds the timers due within `slots_count` ticks, one slot per tick. Each higher level
+            // spans `slots_count` times more, its slots being cascaded to the lower levels when reached
+            std::array<std::uint32_t, levels_count * slots_count> slots;
+
+            const std::chrono::steady_clock::time_point origin {std::chrono::steady_clock::now()};
+
+            std::uint64_t current_tick       {0};
+            std::size_t   armed_timers_count {0};
+
+            boost::asio::steady_timer tick_timer;
+            bool                      is_ticking     {false};
+            std::uint64_t             scheduled_tick {0};
+
+            // Outdates the waits of tick_timer which were rescheduled earlier
+            std::uint64_t tick_generation {0};
+
+            virtual void shutdown() override;
+
+            std::uint64_t getTick(const std::chrono::steady_clock::time_point time) const;
+
+            // Mutex held
+            void insertEntry(const std::uint32_t index);
+            void unlinkEntry(const std::uint32_t index);
+            void releaseEntry(const std::uint32_t index);
+
+            // The tick at which the slot is next reached: when its timers expire (level 0) or are cascaded
+            std::uint64_t getSlotTick(const std::uint32_t slot) const;
+
+            // The first tick at which an occupied slot is reached
+            std::uint64_t getNextTick() const;
+
+            // Wakes the wheel at `wake_tick`, unless it's already woken earlier
+            void scheduleTick(const std::uint64_t wake_tick);
+
+            void tick(const std::uint64_t generation);
+    };
+}
+
+// Implementation
+
+namespace nets
+{
+    inline bool TimerWheel::TimerHandle::isSet() const
+    {
+        return index != std::numeric_limits<std::uint32_t>::max();
+    }
+
+    inline TimerWheel::TimerWheel(boost::asio::io_context& io_context)
+    :
+        boost::asio::execution_context::service{io_context},
+        tick_timer{io_context}
+    {
+        slots.fill(no_entry);
+    }
+
+    inline TimerWheel::TimerHandle TimerWheel::arm(
+        const std::chrono::steady_clock::duration delay,
+        const boost::asio::any_io_executor&       executor,
+        Callback                                  callback
+    )
+    {
+        const auto now {std::chrono::steady_clock::now()};
+
+        std::lock_guard lock {mutex};
+
+        if(armed_timers_count == 0)
+        {
+            // Nothing to cascade: the wheel catches up at once
+            current_tick = getTick(now);
+        }
+
+        std::uint32_t index {0};
+
+        if(!free_entries.empty())
+        {
+            index = free_entries.back();
+
+            free_entries.pop_back();
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(entries.size());
+
+            entries.emplace_back();
+        }
+
+        auto& entry {entries[index]};
+
+        // Rounded up to the tick following the deadline, and never due on the current tick, which may already have been handled
+        const auto deadline {now + std::max(delay, std::chrono::steady_clock::duration{0})};
+
+        entry.expiry_tick = std::max(getTick(deadline + tick_duration - std::chrono::steady_clock::duration{1}), current_tick + 1);
+        entry.is_armed    = true;
+        entry.executor    = executor;
+        entry.callback    = std::move(callback);
+
+        insertEntry(index);
+
+        ++armed_timers_count;
+
+        // Every other timer is reached at the scheduled tick or later
+        scheduleTick(getSlotTick(entry.slot));
+
+        return {index, entry.generation};
+    }
+
+    inline bool TimerWheel::cancel(TimerHandle& handle)
+    {
+        const auto cancelled_handle {std::exchange(handle, TimerHandle{})};
+        const auto index            {cancelled_handle.index};
+
+        if(index == no_entry)
+        {
+            return false;
+        }
+
+        Callback cancelled_callback;
+
+        {
+            std::lock_guard lock {mutex};
+
+            if(index >= entries.size() || !entries[index].is_armed || entries[index].generation != cancelled_handle.generation)
+            {
+                return false;
+            }
+
+            unlinkEntry(index);
+
+            // The callback is destroyed outside of the lock, as it may own anything
+            cancelled_callback = std::move(entries[index].callback);
+
+            releaseEntry(index);
+
+            --armed_timers_count;
+        }
+
+        return true;
+    }
+
+    inline std::size_t TimerWheel::getArmedTimersCount() const
+    {
+        std::lock_guard lock {mutex};
+
+        return armed_timers_count;
+    }
+
+    inline void TimerWheel::shutdown()
+    {
+        std::vector<Entry> destroyed_entries;
+
+        {
+            std::lock_guard lock {mutex};
+
+            destroyed_entries = std::move(entries);
+
+            entries.clear();
+            free_entries.clear();
+
+            slots.fill(no_entry);
+
+            armed_timers_count = 0;
+            is_ticking         = false;
+
+            tick_timer.cancel();
+        }
+    }
+
+    inline std::uint64_t TimerWheel::getTick(const std::chrono::steady_clock::time_point time) const
+    {
+        return static_cast<std::uint64_t>((time - origin) / tick_duration);
+    }
+
+    inline void TimerWheel::insertEntry(const std::uint32_t index)
+    {
+        auto& entry {entries[index]};
+
+        const auto ticks_left {entry.expiry_tick > current_tick ? entry.expiry_tick - current_tick : 0};
+
+        std::size_t level {0};
+
+        while(level < levels_count - 1 && ticks_left >= (std::uint64_t{1} << (slot_bits * (level + 1))))
+        {
+            ++level;
+        }
+
+        std::size_t slot {0};
+
+        if(ticks_left >= (std::uint64_t{1} << (slot_bits * levels_count)))
+        {
+            // Beyond the wheel: parked in the farthest slot, and inserted again once cascaded
+            slot = ((current_tick >> (slot_bits * level)) + slot_mask) & slot_mask;
+        }
+        else
+        {
+            slot = (entry.expiry_tick >> (slot_bits * level)) & slot_mask;
+        }
+
+        entry.slot     = static_cast<std::uint32_t>(level * slots_count + slot);
+        entry.previous = no_entry;
+        entry.next     = slots[entry.slot];
+
+        if(entry.next != no_entry)
+        {
+            entries[entry.next].previous = index;
+        }
+
+        slots[entry.slot] = index;
+    }
+
+    inline void TimerWheel::unlinkEntry(const std::uint32_t index)
+    {
+        auto& entry {entries[index]};
+
+        if(entry.previous != no_entry)
+        {
+            entries[entry.previous].next = entry.next;
+        }
+        else
+        {
+            slots[entry.slot] = entry.next;
+        }
+
+        if(entry.next != no_entry)
+        {
+            entries[entry.next].previous = entry.previous;
+        }
+
+        entry.previous = no_entry;
+        entry.next     = no_entry;
+    }
+
+    inline void TimerWheel::releaseEntry(const std::uint32_t index)
+    {
+        auto& entry {entries[index]};
+
+        entry.is_armed = false;
+        entry.executor = {};
+        entry.callback = nullptr;
+
+        // Outdates the handles of this timer
+        ++entry.generation;
+
+        free_entries.push_back(index);
+    }
+
+    inline std::uint64_t TimerWheel::getSlotTick(const std::uint32_t slot) const
+    {
+        const auto level    {slot / slots_count};
+        const auto shift    {slot_bits * level};
+        const auto position {current_tick >> shift};
+
+        // Slots ahead of the current one are reached within a turn of the level, the current one after a full turn
+        auto distance {((slot & slot_mask) - position) & slot_mask};
+
+        if(distance == 0)
+        {
+            distance = slots_count;
+        }
+
+        return (position + distance) << shift;
+    }
+
+    inline std::uint64_t TimerWheel::getNextTick() const
+    {
+        auto next_tick {std::numeric_limits<std::uint64_t>::max()};
+
+        for(std::uint32_t slot {0}; slot < slots.size(); ++slot)
+        {
+            if(slots[slot] != no_entry)
+            {
+                next_tick = std::min(next_tick, getSlotTick(slot));
+            }
+        }
+
+        return next_tick;
+    }
+
+    inline void TimerWheel::scheduleTick(const std::uint64_t wake_tick)
+    {
+        if(armed_timers_count == 0 || (is_ticking && scheduled_tick <= wake_tick))
+        {
+            return;
+        }
+
+        is_ticking     = true;
+        scheduled_tick = wake_tick;
+
+        // Cancels the wait scheduled later, if any
+        tick_timer.expires_at(origin + wake_tick * tick_duration);
+
+        tick_timer.async_wait(
+            [this, generation = ++tick_generation](const boost::system::error_code error)
+            {
+                if(!error)
+                {
+                    tick(generation);
+                }
+            }
+        );
+    }
+
+    inline void TimerWheel::tick(const std::uint64_t generation)
+    {
+        std::vector<std::pair<boost::asio::any_io_executor, Callback>> expired_callbacks;
+
+        {
+            std::lock_guard lock {mutex};
+
+            if(generation != tick_generation)
+            {
+                // Rescheduled earlier, but its completion was already queued
+                return;
+            }
+
+            is_ticking = false;
+
+            const auto now_tick {getTick(std::chrono::steady_clock::now())};
+
+            while(current_tick < now_tick && armed_timers_count > 0)
+            {
+                ++current_tick;
+
+                // Higher levels' slots reached by this tick are spread over the lower levels first
+                for(std::size_t level {1}; level < levels_count; ++level)
+                {
+                    if((current_tick & ((std::uint64_t{1} << (slot_bits * level)) - 1)) != 0)
+                    {
+                        break;
+                    }
+
+                    const auto slot {level * slots_count + ((current_tick >> (slot_bits * level)) & slot_mask)};
+
+                    auto index {std::exchange(slots[slot], no_entry)};
+
+                    while(index != no_entry)
+                    {
+                        const auto next {entries[index].next};
+
+                        insertEntry(index);
+
+                        index = next;
+                    }
+                }
+
+                auto index {std::exchange(slots[current_tick & slot_mask], no_entry)};
+
+                while(index != no_entry)
+                {
+                    auto& entry {entries[index]};
+
+                    const auto next {entry.next};
+
+                    expired_callbacks.emplace_back(std::move(entry.executor), std::move(entry.callback));
+
+                    releaseEntry(index);
+
+                    --armed_timers_count;
+
+                    index = next;
+                }
+            }
+
+            if(armed_timers_count == 0)
+            {
+                current_tick = now_tick;
+            }
+
+            scheduleTick(getNextTick());
+        }
+
+        for(auto& [executor, callback] : expired_callbacks)
+        {
+            boost::asio::post(executor, std::move(callback));
+        }
+    }
+}
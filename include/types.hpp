@@ -1,5 +1,9 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
 #include <boost/asio.hpp>
 
 namespace nets
@@ -13,17 +17,93 @@ namespace nets
         ipv4, ipv6
     };
 
+    using PingSequence = std::uint32_t;
+
+    // Unique within the process
+    using ConnectionId = std::uint64_t;
+
+    // Unique within a connection, matching a response to its request
+    using RequestId = std::uint64_t;
+
     enum class PingError
     {
         expired, failed_to_send
     };
 
+    // How a server listens: through one acceptor serving every io thread, or through one
+    // SO_REUSEPORT acceptor per io thread, each with its own io_context and connections
+    enum class ListeningMode
+    {
+        single_acceptor, sharded_acceptors
+    };
+
+    enum class HandlerDispatch
+    {
+        worker_pool, inline_strand
+    };
+
+    // What sending does when a remote's outgoing queue is full
+    enum class BackpressurePolicy
+    {
+        reject, block, drop_oldest, disconnect
+    };
+
+    enum class SendStatus
+    {
+        queued, queue_full, disconnected
+    };
+
+    // How a client pool picks the connection a message is sent through
+    enum class LoadBalancing
+    {
+        round_robin, least_queued_bytes, key_affinity
+    };
+
+    // Delays between a client's reconnection attempts: `initial_delay` multiplied by `multiplier` after each
+    // failed attempt, up to `max_delay`. Each delay is shortened by a random part of up to `jitter` of itself,
+    // so that clients disconnected together don't reconnect together
+    struct ReconnectionPolicy
+    {
+        std::chrono::milliseconds initial_delay {50};
+        std::chrono::milliseconds max_delay     {10'000};
+        double                    multiplier    {2};
+        double                    jitter        {0.5};
+
+        // 0 for no limit
+        std::size_t max_attempts {0};
+    };
+
+    // A connection is closed, failing with boost::asio::error::timed_out, once one of these elapses. 0 disables it
+    struct ConnectionTimeouts
+    {
+        // Nothing received for this long
+        std::chrono::milliseconds idle {0};
+
+        // A write to the socket pending for this long
+        std::chrono::milliseconds write_stall {0};
+
+        // Nothing received this long after the connection started
+        std::chrono::milliseconds handshake {0};
+    };
+
+    // Compressed messages claiming to decompress to more than this are dropped before anything is allocated
+    struct DecompressionLimits
+    {
+        std::size_t max_size {64 * 1024 * 1024};
+
+        // Uncompressed size divided by compressed size
+        std::size_t max_ratio {1024};
+    };
+
     template <typename MessageIdEnum, typename Remote>
     class TcpServer;
 
     template <typename MessageIdEnum, typename Remote>
     class TcpClient;
 
+    template <typename MessageIdEnum, typename Remote>
+    class TcpClientPool;
+
     template <typename MessageIdEnum>
     class TcpRemote;
 }
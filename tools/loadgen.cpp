@@ -0,0 +1,833 @@
+#include "../include/nets.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <optional>
+#include <print>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// nets-loadgen: drives many connections to a server from a small pool of io threads, every client
+// sharing the same io_context. Each connection sends echo requests (at a fixed rate, or one after the
+// other), whose bodies start with their send time so that responses give the round trip time.
+//
+// The target server must answer every `echo_request` with an `echo_response` carrying the same body:
+// `nets-loadgen --serve` runs such a server
+
+enum class MessageIds
+{
+    ping_request, ping_response,
+    echo_request,
+    echo_response,
+    count
+};
+
+using Remote = nets::TcpRemote<MessageIds>;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view usage {
+R"(Usage: nets-loadgen [options]
+
+Load generation:
+    --address ADDRESS       Server address (default 127.0.0.1)
+    --port PORT             Server port (default 60000)
+    --connections N         Connections to open (default 100)
+    --rate N                Messages per second across all connections,
+                            0 to send each request once the previous one is answered (default 0)
+    --payload SIZES         Payload sizes in bytes, at least 8 (default fixed:64):
+                                fixed:N, uniform:MIN:MAX or exponential:MEAN
+    --ramp-up SECONDS       Time over which connections are opened (default 0)
+    --duration SECONDS      Time spent sending once every connection is opened (default 10)
+    --threads N             io threads shared by the connections (default: hardware threads)
+
+Echo server:
+    --serve                 Run a server answering echo requests on --port, until interrupted
+)"
+};
+
+enum class PayloadDistribution
+{
+    fixed, uniform, exponential
+};
+
+struct PayloadSizes
+{
+    PayloadDistribution distribution {PayloadDistribution::fixed};
+
+    // Size (fixed), minimum (uniform) or mean (exponential)
+    std::size_t first  {64};
+    std::size_t second {64};
+
+    std::size_t sample(std::mt19937_64& random) const;
+};
+
+struct Options
+{
+    std::string address {"127.0.0.1"};
+    nets::Port  port    {60000};
+
+    std::size_t  connections_count {100};
+    double       rate              {0};
+    PayloadSizes payload_sizes;
+
+    Clock::duration ramp_up  {0};
+    Clock::duration duration {std::chrono::seconds{10}};
+
+    std::size_t threads_count {std::max<std::size_t>(std::thread::hardware_concurrency(), 1)};
+
+    bool serve {false};
+};
+
+// Latencies with 32 linear sub-buckets per power of two nanoseconds, so that percentiles are within 3%
+// whatever the scale. Recorded with relaxed atomics from any io thread
+class LatencyHistogram
+{
+    public:
+        void record(const Clock::duration latency);
+
+        std::uint64_t getCount() const;
+
+        // Lower bound of the bucket holding the `quantile` (in [0, 1]) of the samples
+        std::chrono::nanoseconds getQuantile(const double quantile) const;
+
+        std::chrono::nanoseconds getMax() const;
+
+    private:
+        static constexpr unsigned    sub_buckets_bits  {5};
+        static constexpr std::size_t sub_buckets_count {1 << sub_buckets_bits};
+
+        // Latencies are clamped below 2^40 ns (about 18 minutes)
+        static constexpr unsigned    max_exponent  {40};
+        static constexpr std::size_t buckets_count {(max_exponent - sub_buckets_bits + 1) * sub_buckets_count};
+
+        static std::size_t   getBucket     (const std::uint64_t latency_ns);
+        static std::uint64_t getBucketBound(const std::size_t   bucket);
+
+        std::array<std::atomic_uint64_t, buckets_count> buckets {};
+
+        std::atomic_uint64_t max_latency_ns {0};
+};
+
+struct LoadStatistics
+{
+    std::atomic_size_t connected           {0};
+    std::atomic_size_t connection_failures {0};
+    std::atomic_size_t disconnections      {0};
+
+    std::atomic_uint64_t requests_sent       {0};
+    std::atomic_uint64_t send_failures       {0};
+    std::atomic_uint64_t responses_received  {0};
+    std::atomic_uint64_t malformed_responses {0};
+
+    LatencyHistogram latencies;
+};
+
+// Doesn't run a thread per connection: the loop is driven by the connection's timer and responses
+class LoadClient : public nets::TcpClient<MessageIds, Remote>
+{
+    public:
+        using TcpClient<MessageIds, Remote>::TcpClient;
+
+        virtual boost::asio::awaitable<void> onSession(std::shared_ptr<Remote> server) override
+        {
+            co_return;
+        }
+};
+
+// Runs on the connection's strand only: clients sharing an io_context run their handlers inline
+class Connection : public std::enable_shared_from_this<Connection>
+{
+    public:
+        Connection(
+            boost::asio::io_context& io_context,
+            const Options&           options,
+            LoadStatistics&          statistics,
+            const std::atomic_bool&  sending,
+            const std::uint64_t      seed
+        );
+
+        void connect();
+
+    private:
+        const Options&          options;
+        LoadStatistics&         statistics;
+        const std::atomic_bool& sending;
+
+        std::unique_ptr<LoadClient> client;
+
+        // Bound to the connection's strand
+        boost::asio::steady_timer send_timer;
+
+        // Requests are timestamped with the time they were due, not the time they were sent, so that
+        // a late sender doesn't hide the latency it causes
+        Clock::time_point next_send_time;
+        Clock::duration   send_period;
+
+        std::mt19937_64 random;
+
+        void onConnected();
+        void scheduleSend();
+        void sendRequest(const Clock::time_point due_time);
+        void handleResponse(const nets::MessageView& response);
+};
+
+class EchoRemote : public Remote
+{
+    public:
+        // Handler set before the remote starts reading, so that no request is missed
+        EchoRemote(
+            boost::asio::io_context& io_context,
+            nets::TcpSocket&&        socket,
+            const PingTime           ping_timeout_period,
+            const PingTime           ping_delay
+        );
+};
+
+class EchoServer : public nets::TcpServer<MessageIds, EchoRemote>
+{
+    public:
+        using TcpServer<MessageIds, EchoRemote>::TcpServer;
+
+        virtual boost::asio::awaitable<void> onClientSession(std::shared_ptr<EchoRemote> client) override
+        {
+            co_return;
+        }
+
+        virtual void onForbiddenClientConnection(std::shared_ptr<EchoRemote> client) override {}
+};
+
+constexpr std::size_t timestamp_size {sizeof(std::int64_t)};
+
+std::size_t PayloadSizes::sample(std::mt19937_64& random) const
+{
+    switch(distribution)
+    {
+        case PayloadDistribution::uniform:
+            return std::uniform_int_distribution<std::size_t>{first, second}(random);
+
+        case PayloadDistribution::exponential:
+            return std::max(
+                timestamp_size,
+                static_cast<std::size_t>(std::exponential_distribution<double>{1.0 / static_cast<double>(first)}(random))
+            );
+
+        default:
+            return first;
+    }
+}
+
+void LatencyHistogram::record(const Clock::duration latency)
+{
+    const auto latency_ns {static_cast<std::uint64_t>(std::max<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), 0
+    ))};
+
+    buckets[getBucket(latency_ns)].fetch_add(1, std::memory_order_relaxed);
+
+    auto max_ns {max_latency_ns.load(std::memory_order_relaxed)};
+
+    while(latency_ns > max_ns && !max_latency_ns.compare_exchange_weak(max_ns, latency_ns, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::uint64_t LatencyHistogram::getCount() const
+{
+    std::uint64_t count {0};
+
+    for(const auto& bucket : buckets)
+    {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::getQuantile(const double quantile) const
+{
+    const auto count {getCount()};
+
+    if(count == 0)
+    {
+        return {};
+    }
+
+    // Rank of the sample, from 1
+    const auto rank {std::max<std::uint64_t>(static_cast<std::uint64_t>(quantile * static_cast<double>(count) + 0.5), 1)};
+
+    std::uint64_t cumulated_count {0};
+
+    for(std::size_t i {0}; i < buckets_count; ++i)
+    {
+        cumulated_count += buckets[i].load(std::memory_order_relaxed);
+
+        if(cumulated_count >= rank)
+        {
+            return std::chrono::nanoseconds{getBucketBound(i)};
+        }
+    }
+
+    return getMax();
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const
+{
+    return std::chrono::nanoseconds{max_latency_ns.load(std::memory_order_relaxed)};
+}
+
+std::size_t LatencyHistogram::getBucket(const std::uint64_t latency_ns)
+{
+    const auto clamped_ns {std::min<std::uint64_t>(latency_ns, (std::uint64_t{1} << max_exponent) - 1)};
+
+    if(clamped_ns < sub_buckets_count)
+    {
+        return clamped_ns;
+    }
+
+    // Below 2^(exponent + 1), split in sub_buckets_count buckets of 2^shift
+    const auto exponent {static_cast<unsigned>(std::bit_width(clamped_ns)) - 1};
+    const auto shift    {exponent - sub_buckets_bits};
+
+    return shift * sub_buckets_count + (clamped_ns >> shift);
+}
+
+std::uint64_t LatencyHistogram::getBucketBound(const std::size_t bucket)
+{
+    if(bucket < 2 * sub_buckets_count)
+    {
+        return bucket;
+    }
+
+    const auto shift {bucket / sub_buckets_count - 1};
+
+    return (bucket % sub_buckets_count + sub_buckets_count) << shift;
+}
+
+Connection::Connection(
+    boost::asio::io_context& io_context,
+    const Options&           options,
+    LoadStatistics&          statistics,
+    const std::atomic_bool&  sending,
+    const std::uint64_t      seed
+)
+:
+    options{options},
+    statistics{statistics},
+    sending{sending},
+
+    client{
+        std::make_unique<LoadClient>(
+            io_context, options.address, std::to_string(options.port), Remote::PingTime{30}, Remote::PingTime{30}
+        )
+    },
+
+    send_timer{client->server->getSocket().get_executor()},
+
+    send_period{
+        options.rate > 0
+        ?
+            std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>{static_cast<double>(options.connections_count) / options.rate}
+            )
+        :
+            Clock::duration{0}
+    },
+
+    random{seed}
+{}
+
+void Connection::connect()
+{
+    // Handlers are set before connecting: the remote starts reading as soon as it's connected
+    client->server->setOnReceivingView(
+        MessageIds::echo_response,
+        [weak_self = weak_from_this()](nets::MessageView response, Remote&)
+        {
+            if(const auto self {weak_self.lock()})
+            {
+                self->handleResponse(response);
+            }
+        }
+    );
+
+    client->server->onFailedReading = [this](std::optional<boost::system::error_code>)
+    {
+        statistics.connected.fetch_sub(1, std::memory_order_relaxed);
+
+        if(sending.load(std::memory_order_relaxed))
+        {
+            statistics.disconnections.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    client->asyncConnect(
+        [self = shared_from_this()](const boost::system::error_code error)
+        {
+            if(error)
+            {
+                //std::println("DEBUG: Connection failed: {}", error.message());
+
+                self->statistics.connection_failures.fetch_add(1, std::memory_order_relaxed);
+
+                return;
+            }
+
+            self->statistics.connected.fetch_add(1, std::memory_order_relaxed);
+
+            self->onConnected();
+        }
+    );
+}
+
+void Connection::onConnected()
+{
+    if(send_period == Clock::duration{0})
+    {
+        sendRequest(Clock::now());
+
+        return;
+    }
+
+    // Connections don't all send at the same instants
+    next_send_time = Clock::now() + std::uniform_int_distribution<Clock::rep>{0, send_period.count()}(random) * Clock::duration{1};
+
+    scheduleSend();
+}
+
+void Connection::scheduleSend()
+{
+    send_timer.expires_at(next_send_time);
+
+    send_timer.async_wait(
+        [self = shared_from_this()](const boost::system::error_code error)
+        {
+            if(error || !self->sending.load(std::memory_order_relaxed) || !self->client->server->isConnected())
+            {
+                return;
+            }
+
+            // Catches up with the requests that were due meanwhile
+            const auto now {Clock::now()};
+
+            while(self->next_send_time <= now)
+            {
+                self->sendRequest(self->next_send_time);
+
+                self->next_send_time += self->send_period;
+            }
+
+            self->scheduleSend();
+        }
+    );
+}
+
+void Connection::sendRequest(const Clock::time_point due_time)
+{
+    const auto payload_size {std::max(options.payload_sizes.sample(random), timestamp_size)};
+
+    mdsm::Collection request;
+
+    request << MessageIds::echo_request;
+
+    const auto header_size {request.getSize()};
+
+    request.resize(header_size + payload_size);
+
+    const std::int64_t timestamp {due_time.time_since_epoch().count()};
+
+    std::memcpy(request.getData() + header_size, &timestamp, timestamp_size);
+    std::memset(request.getData() + header_size + timestamp_size, 'x', payload_size - timestamp_size);
+
+    if(client->server->trySend(std::move(request)) == nets::SendStatus::queued)
+    {
+        statistics.requests_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        statistics.send_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Connection::handleResponse(const nets::MessageView& response)
+{
+    if(response.getSize() < timestamp_size)
+    {
+        statistics.malformed_responses.fetch_add(1, std::memory_order_relaxed);
+
+        return;
+    }
+
+    std::int64_t timestamp;
+
+    std::memcpy(&timestamp, response.getData(), timestamp_size);
+
+    statistics.latencies.record(Clock::now() - Clock::time_point{Clock::duration{timestamp}});
+
+    statistics.responses_received.fetch_add(1, std::memory_order_relaxed);
+
+    if(send_period == Clock::duration{0} && sending.load(std::memory_order_relaxed))
+    {
+        sendRequest(Clock::now());
+    }
+}
+
+EchoRemote::EchoRemote(
+    boost::asio::io_context& io_context,
+    nets::TcpSocket&&        socket,
+    const PingTime           ping_timeout_period,
+    const PingTime           ping_delay
+)
+:
+    Remote{io_context, std::move(socket), ping_timeout_period, ping_delay}
+{
+    setOnReceivingView(
+        MessageIds::echo_request,
+        [](nets::MessageView request, Remote& client)
+        {
+            mdsm::Collection response;
+
+            response << MessageIds::echo_response;
+
+            const auto header_size {response.getSize()};
+
+            response.resize(header_size + request.getSize());
+
+            std::memcpy(response.getData() + header_size, request.getData(), request.getSize());
+
+            client.send(std::move(response));
+        }
+    );
+}
+
+template <typename Number>
+bool parseNumber(const std::string_view text, Number& number)
+{
+    const auto result {std::from_chars(text.data(), text.data() + text.size(), number)};
+
+    return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+}
+
+std::optional<PayloadSizes> parsePayloadSizes(const std::string_view text)
+{
+    PayloadSizes payload_sizes;
+
+    const auto separator {text.find(':')};
+
+    const auto distribution {text.substr(0, separator)};
+    const auto parameters   {separator == std::string_view::npos ? std::string_view{} : text.substr(separator + 1)};
+
+    if(distribution == "fixed" && parseNumber(parameters, payload_sizes.first))
+    {
+        payload_sizes.distribution = PayloadDistribution::fixed;
+        payload_sizes.second       = payload_sizes.first;
+    }
+    else if(
+        const auto bounds_separator {parameters.find(':')};
+        distribution == "uniform" &&
+        bounds_separator != std::string_view::npos &&
+        parseNumber(parameters.substr(0, bounds_separator), payload_sizes.first) &&
+        parseNumber(parameters.substr(bounds_separator + 1), payload_sizes.second) &&
+        payload_sizes.first <= payload_sizes.second
+    )
+    {
+        payload_sizes.distribution = PayloadDistribution::uniform;
+    }
+    else if(distribution == "exponential" && parseNumber(parameters, payload_sizes.first) && payload_sizes.first > 0)
+    {
+        payload_sizes.distribution = PayloadDistribution::exponential;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+
+    if(payload_sizes.first < timestamp_size || payload_sizes.second > nets::max_frame_size - sizeof(MessageIds))
+    {
+        return std::nullopt;
+    }
+
+    return payload_sizes;
+}
+
+std::optional<Options> parseOptions(const int arguments_count, char** arguments)
+{
+    Options options;
+
+    for(int i {1}; i < arguments_count; ++i)
+    {
+        const std::string_view option {arguments[i]};
+
+        if(option == "--serve")
+        {
+            options.serve = true;
+
+            continue;
+        }
+
+        if(i + 1 == arguments_count)
+        {
+            std::println(stderr, "Missing value of {}", option);
+
+            return std::nullopt;
+        }
+
+        const std::string_view value {arguments[++i]};
+
+        double seconds {0};
+
+        bool valid {true};
+
+        if(option == "--address")
+        {
+            options.address = value;
+        }
+        else if(option == "--port")
+        {
+            valid = parseNumber(value, options.port);
+        }
+        else if(option == "--connections")
+        {
+            valid = parseNumber(value, options.connections_count) && options.connections_count > 0;
+        }
+        else if(option == "--rate")
+        {
+            valid = parseNumber(value, options.rate) && options.rate >= 0;
+        }
+        else if(option == "--payload")
+        {
+            const auto payload_sizes {parsePayloadSizes(value)};
+
+            valid = payload_sizes.has_value();
+
+            if(valid)
+            {
+                options.payload_sizes = *payload_sizes;
+            }
+        }
+        else if(option == "--ramp-up" || option == "--duration")
+        {
+            valid = parseNumber(value, seconds) && seconds >= 0;
+
+            (option == "--ramp-up" ? options.ramp_up : options.duration) =
+                std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{seconds});
+        }
+        else if(option == "--threads")
+        {
+            valid = parseNumber(value, options.threads_count) && options.threads_count > 0;
+        }
+        else
+        {
+            std::println(stderr, "Unknown option {}", option);
+
+            return std::nullopt;
+        }
+
+        if(!valid)
+        {
+            std::println(stderr, "Invalid value of {}: {}", option, value);
+
+            return std::nullopt;
+        }
+    }
+
+    return options;
+}
+
+double toMicroseconds(const std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+void printProgress(const LoadStatistics& statistics, const Clock::duration elapsed, std::uint64_t& last_responses_count)
+{
+    const auto responses_count {statistics.responses_received.load(std::memory_order_relaxed)};
+
+    std::println(
+        "{:8.1f}s  connections {:>6}  sent {:>10}  received {:>10}  {:>8} msg/s",
+        std::chrono::duration<double>(elapsed).count(),
+        statistics.connected.load(std::memory_order_relaxed),
+        statistics.requests_sent.load(std::memory_order_relaxed),
+        responses_count,
+        responses_count - last_responses_count
+    );
+
+    last_responses_count = responses_count;
+}
+
+int runLoad(const Options& options)
+{
+    // Destroyed last: pending handlers hold the connections until then
+    boost::asio::io_context io_context;
+
+    auto io_context_work {boost::asio::make_work_guard(io_context)};
+
+    std::vector<std::thread> io_threads;
+
+    for(std::size_t i {0}; i < options.threads_count; ++i)
+    {
+        io_threads.emplace_back([&]{ io_context.run(); });
+    }
+
+    LoadStatistics statistics;
+
+    std::atomic_bool sending {true};
+
+    std::vector<std::shared_ptr<Connection>> connections;
+
+    connections.reserve(options.connections_count);
+
+    const auto start {Clock::now()};
+
+    std::uint64_t last_responses_count {0};
+
+    auto next_progress_time {start + std::chrono::seconds{1}};
+
+    // Connections are opened evenly over the ramp-up
+    for(std::size_t i {0}; i < options.connections_count; ++i)
+    {
+        std::this_thread::sleep_until(
+            start + options.ramp_up * static_cast<Clock::rep>(i) / static_cast<Clock::rep>(options.connections_count)
+        );
+
+        connections.push_back(std::make_shared<Connection>(io_context, options, statistics, sending, i));
+
+        connections.back()->connect();
+
+        if(Clock::now() >= next_progress_time)
+        {
+            printProgress(statistics, Clock::now() - start, last_responses_count);
+
+            next_progress_time += std::chrono::seconds{1};
+        }
+    }
+
+    const auto end {std::max(Clock::now(), start + options.ramp_up) + options.duration};
+
+    while(next_progress_time <= end)
+    {
+        std::this_thread::sleep_until(next_progress_time);
+
+        printProgress(statistics, Clock::now() - start, last_responses_count);
+
+        next_progress_time += std::chrono::seconds{1};
+    }
+
+    std::this_thread::sleep_until(end);
+
+    const auto elapsed {Clock::now() - start};
+
+    sending = false;
+
+    // Gives in-flight requests a chance to be answered
+    const auto drain_deadline {Clock::now() + std::chrono::seconds{2}};
+
+    while(
+        statistics.responses_received.load() + statistics.malformed_responses.load() < statistics.requests_sent.load() &&
+        Clock::now() < drain_deadline
+    )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    io_context.stop();
+
+    for(auto& io_thread : io_threads)
+    {
+        io_thread.join();
+    }
+
+    const auto requests_count  {statistics.requests_sent.load()};
+    const auto responses_count {statistics.responses_received.load()};
+
+    const auto& latencies {statistics.latencies};
+
+    std::println(
+        "{{\"connections\": {}, \"connection_failures\": {}, \"disconnections\": {}, "
+        "\"requests\": {}, \"responses\": {}, \"unanswered\": {}, \"send_failures\": {}, \"malformed_responses\": {}, "
+        "\"seconds\": {:.3f}, \"responses_per_second\": {:.0f}, "
+        "\"p50_us\": {:.1f}, \"p90_us\": {:.1f}, \"p99_us\": {:.1f}, \"p999_us\": {:.1f}, \"max_us\": {:.1f}}}",
+        options.connections_count - statistics.connection_failures.load(),
+        statistics.connection_failures.load(),
+        statistics.disconnections.load(),
+        requests_count,
+        responses_count,
+        requests_count - std::min(requests_count, responses_count + statistics.malformed_responses.load()),
+        statistics.send_failures.load(),
+        statistics.malformed_responses.load(),
+        std::chrono::duration<double>(elapsed).count(),
+        static_cast<double>(responses_count) / std::chrono::duration<double>(elapsed).count(),
+        toMicroseconds(latencies.getQuantile(0.5)),
+        toMicroseconds(latencies.getQuantile(0.9)),
+        toMicroseconds(latencies.getQuantile(0.99)),
+        toMicroseconds(latencies.getQuantile(0.999)),
+        toMicroseconds(latencies.getMax())
+    );
+
+    return statistics.connection_failures.load() == 0 ? 0 : 2;
+}
+
+int runServer(const Options& options)
+{
+    EchoServer server {Remote::PingTime{30}, Remote::PingTime{30}, options.threads_count};
+
+    server.setIpVersion(nets::IPVersion::ipv4);
+    server.setPort(options.port);
+    server.setHandlerDispatch(nets::HandlerDispatch::inline_strand);
+
+    if(!server.startAccepting())
+    {
+        std::println(stderr, "Failed to listen on port {}", options.port);
+
+        return 1;
+    }
+
+    std::println("Serving echo requests on port {}", options.port);
+
+    boost::asio::io_context signals_io_context;
+
+    boost::asio::signal_set signals {signals_io_context, SIGINT, SIGTERM};
+
+    signals.async_wait([](const boost::system::error_code, const int){});
+
+    signals_io_context.run();
+
+    const auto metrics {server.getMetrics()};
+
+    std::println(
+        "{{\"connections_accepted\": {}, \"messages_received\": {}, \"messages_sent\": {}}}",
+        metrics.connections_accepted,
+        metrics.connections.messages_received,
+        metrics.connections.messages_sent
+    );
+
+    server.closeAllConnections();
+
+    return 0;
+}
+
+int main(int arguments_count, char** arguments)
+{
+    const auto options {parseOptions(arguments_count, arguments)};
+
+    if(!options)
+    {
+        std::print(stderr, "{}", usage);
+
+        return 1;
+    }
+
+    return options->serve ? runServer(*options) : runLoad(*options);
+}